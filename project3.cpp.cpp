@@ -4,41 +4,326 @@
 #include <fstream>
 #include <iomanip>
 #include <limits>
+#include <cmath>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include <string_view>
+#include <charconv>
+#include <thread>
+#include <algorithm>
+#include <iterator>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <cerrno>
+#include <cstdio>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <dirent.h>
 
 // --- Data Structures ---
-// A struct to represent a student with their ID, name, and a list of grades.
+// Running aggregates over a set of grades, updated as each grade is added
+// so that count, average, spread and range are available in O(1).
+struct GradeStats {
+    uint64_t count = 0;
+    double sum = 0.0;
+    double sumOfSquares = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+};
+
+// A struct to represent a student with their ID, name, and the range of
+// their grades in the roster's shared grade buffer. The range has room for
+// gradeCapacity grades, of which the first gradeCount are in use.
 struct Student {
     std::string id;
     std::string name;
+    uint64_t gradeOffset = 0;
+    uint32_t gradeCount = 0;
+    uint32_t gradeCapacity = 0;
+    GradeStats stats;
+};
+
+// A read-only view of a contiguous run of grades.
+struct GradeSpan {
+    const double* data;
+    size_t size;
+
+    const double* begin() const { return data; }
+    const double* end() const { return data + size; }
+    bool empty() const { return size == 0; }
+};
+
+// One slot of the student index. hash is the full 64-bit hash of the ID
+// (0 marks an empty slot), so a probe only has to look at the Student
+// itself when the hashes already match.
+struct IndexSlot {
+    uint64_t hash;
+    int32_t position;
+};
+
+// An open-addressing hash index from student ID to position in the
+// students vector, using linear probing over a power-of-two table that is
+// kept at most half full.
+struct StudentIndex {
+    std::vector<IndexSlot> slots;
+    size_t count = 0;
+};
+
+// All students together with the index used to look them up by ID. Every
+// grade lives in the single grades buffer (a CSR layout); each student owns
+// one range of it. When a full range grows it moves to the end of the
+// buffer with double the capacity, and the slots it leaves behind are
+// counted in unusedGrades until the buffer is compacted. totals aggregates
+// every grade in the roster, and journalSequence is the sequence number of
+// the last journal record reflected in it.
+struct Roster {
+    std::vector<Student> students;
     std::vector<double> grades;
+    size_t unusedGrades = 0;
+    StudentIndex index;
+    GradeStats totals;
+    uint64_t journalSequence = 0;
+};
+
+// --- Binary Snapshot Format ---
+// A snapshot file is laid out as, in order:
+//   SnapshotHeader
+//   SnapshotStudent[studentCount]
+//   uint64_t gradeOffsets[studentCount + 1]   (CSR row offsets into grades)
+//   double grades[gradeCount]                 (every grade, one column)
+//   char strings[stringBytes]                 (each ID followed by its name)
+// All sections are 8-byte aligned and stored in native byte order, so a
+// mapped file can be read in place without any parsing.
+// Version 2 added journalSequence; version 1 files are still read.
+const char SNAPSHOT_MAGIC[8] = {'G', 'R', 'A', 'D', 'E', 'S', 'N', 'P'};
+const uint32_t SNAPSHOT_VERSION = 2;
+const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t studentCount;
+    uint64_t gradeCount;
+    uint64_t stringBytes;
+    uint64_t studentsOffset;
+    uint64_t gradeOffsetsOffset;
+    uint64_t gradesOffset;
+    uint64_t stringsOffset;
+    uint64_t journalSequence;
+};
+
+// Size of the version 1 header, which ended before journalSequence.
+const size_t SNAPSHOT_V1_HEADER_SIZE = offsetof(SnapshotHeader, journalSequence);
+
+struct SnapshotStudent {
+    uint64_t stringOffset;
+    uint32_t idLength;
+    uint32_t nameLength;
+};
+
+// --- Write-Ahead Journal ---
+// Every addStudent/addGrade is appended to a journal before it is applied,
+// so a save only writes the bytes of the operations themselves. The journal
+// is split into numbered segment files (grades.journal.000001, ...). A
+// checkpoint starts a new segment, writes a snapshot of the roster in the
+// background, and then deletes the segments the snapshot covers. At
+// startup, records newer than the snapshot's journalSequence are replayed.
+//
+// Each record is a JournalRecordHeader followed by its payload:
+//   JOURNAL_ADD_STUDENT: uint32 idLength, uint32 nameLength, id, name
+//   JOURNAL_ADD_GRADE:   uint32 idLength, id, double grade
+// A record whose checksum does not match marks a torn write at the end of
+// the journal, and replay stops there. If a write or flush fails, the
+// unflushed records are dropped and cut off the segment, and the next
+// operation starts a new segment, so replay never meets a half-written
+// record followed by newer ones.
+const uint8_t JOURNAL_ADD_STUDENT = 1;
+const uint8_t JOURNAL_ADD_GRADE = 2;
+
+struct JournalRecordHeader {
+    uint32_t payloadLength;
+    uint32_t checksum;
+    uint64_t sequence;
+    uint8_t type;
+    uint8_t padding[7];
+};
+
+// A checkpoint is started automatically once the active segment grows past
+// this size, which bounds both journal disk use and replay time.
+const uint64_t JOURNAL_CHECKPOINT_BYTES = 16 << 20;
+
+// An append-only journal segment with group commit. Callers append records
+// to an in-memory batch; a background thread writes whatever has
+// accumulated with a single write() and fdatasync(), so concurrent or
+// rapid appends share one disk flush.
+class Journal {
+public:
+    ~Journal();
+    bool open(const std::string& path, uint64_t firstSequence);
+    uint64_t append(uint8_t type, const std::string& payload);
+    bool waitDurable(uint64_t sequence);
+    void close();
+    uint64_t lastSequence();
+    uint64_t bytesWritten() const { return bytes; }
+
+private:
+    void flushLoop();
+
+    int fd = -1;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable durable;
+    std::string pending;
+    uint64_t nextSequence = 1;
+    uint64_t appendedSequence = 0;
+    uint64_t durableSequence = 0;
+    std::atomic<uint64_t> bytes{0};
+    bool stopping = false;
+    bool failed = false;
+    std::thread flusher;
+};
+
+// The on-disk state of the roster: the snapshot file, the journal segments
+// and the background checkpoint writer.
+struct Storage {
+    std::string snapshotPath;
+    std::string journalBase;
+    uint64_t activeSegment = 0;
+    Journal journal;
+    std::thread checkpointer;
+    std::atomic<bool> checkpointFailed{false};
+
+    ~Storage() {
+        if (checkpointer.joinable()) checkpointer.join();
+    }
 };
 
+// Files smaller than this per thread are parsed on fewer threads, since
+// starting a thread would cost more than parsing the block.
+const size_t PARALLEL_PARSE_MIN_BLOCK = 4 << 20;
+
+// Analytics passes use one thread per this many grades, up to one per core.
+const uint64_t ANALYTICS_GRADES_PER_THREAD = 1 << 20;
+
 // --- Function Prototypes ---
 // Function to display the main menu to the user.
 void displayMenu();
 
 // Functions for managing student data.
-void addStudent(std::vector<Student>& students);
-void addGrade(std::vector<Student>& students);
-void displayGrades(const std::vector<Student>& students);
-void calculateAverage(const std::vector<Student>& students);
+void addStudent(Roster& roster, Storage& storage);
+void addGrade(Roster& roster, Storage& storage);
+void displayGrades(const Roster& roster);
+void calculateAverage(const Roster& roster);
+void displayStudentStats(const Roster& roster);
+void displayRosterStats(const Roster& roster);
+int runCommand(const Roster& roster, int argc, char* argv[]);
+
+// Functions for roster-wide analytics.
+void reportTopStudents(const Roster& roster, size_t k);
+void reportPercentiles(const Roster& roster, const std::vector<double>& percents);
+void reportHistogram(const Roster& roster, int bucketCount);
+void reportFailingStudents(const Roster& roster, double threshold);
+
+// Functions for the running grade aggregates.
+void addToStats(GradeStats& stats, double grade);
+double statsAverage(const GradeStats& stats);
+double statsStandardDeviation(const GradeStats& stats);
+void printStats(const GradeStats& stats);
+void rebuildStats(Roster& roster);
 
 // Functions for file I/O to save and load data.
-void saveData(const std::vector<Student>& students, const std::string& filename);
-void loadData(std::vector<Student>& students, const std::string& filename);
+void saveData(const Roster& roster, const std::string& filename);
+bool loadData(Roster& roster, const std::string& filename);
+std::vector<char> buildSnapshot(const Roster& roster);
+bool writeSnapshotFile(const std::vector<char>& snapshot, const std::string& filename);
+bool loadSnapshot(Roster& roster, const std::string& filename);
+
+// Functions for the write-ahead journal and checkpoints.
+std::string encodeUint32(uint32_t value);
+bool writeAll(int fd, const char* data, size_t length);
+std::vector<std::pair<uint64_t, std::string>> listJournalSegments(const std::string& journalBase);
+size_t replayJournal(Roster& roster, const std::string& path);
+bool openStorage(Storage& storage, const Roster& roster);
+bool logOperation(Roster& roster, Storage& storage, uint8_t type, const std::string& payload);
+void startCheckpoint(Storage& storage, const Roster& roster);
+bool checkpointNow(Storage& storage, const Roster& roster);
+void closeStorage(Storage& storage, const Roster& roster);
+
+// Functions for the shared grade buffer.
+bool isValidGrade(double grade);
+GradeSpan studentGrades(const Roster& roster, const Student& student);
+void appendGrade(Roster& roster, int position, double grade);
+void compactGrades(Roster& roster);
+
+// Functions for maintaining the student index.
+uint64_t hashStudentId(const std::string& id);
+void reserveIndex(StudentIndex& index, size_t studentCount);
+bool insertIntoIndex(Roster& roster, int position);
 
 // Helper function to find a student by their ID.
-int findStudentById(const std::vector<Student>& students, const std::string& id);
+int findStudentById(const Roster& roster, const std::string& id);
 
 // --- Main Program ---
-int main() {
-    // A vector to hold all student objects.
-    std::vector<Student> students;
+int main(int argc, char* argv[]) {
+    // All student objects and their lookup index.
+    Roster roster;
     const std::string filename = "grades.txt";
+    const std::string snapshotFilename = "grades.dat";
+    Storage storage;
+    storage.snapshotPath = snapshotFilename;
+    storage.journalBase = "grades.journal";
     int choice;
 
-    // Load data from file at program start.
-    loadData(students, filename);
+    // Arguments select a one-shot command instead of the menu. The loaders
+    // report progress on std::cout, so it is muted to keep the output clean.
+    std::streambuf* consoleBuffer = argc > 1 ? std::cout.rdbuf(nullptr) : nullptr;
+
+    // Load data at program start, importing the text file only if there is
+    // no binary snapshot yet. A snapshot that exists but cannot be loaded
+    // stops the program: falling back to the older text file and replaying
+    // the journal onto it would overwrite the snapshot with stale data.
+    struct stat snapshotStat;
+    if (stat(snapshotFilename.c_str(), &snapshotStat) == 0 || errno != ENOENT) {
+        if (!loadSnapshot(roster, snapshotFilename)) {
+            std::cerr << "Error: " << snapshotFilename << " exists but could not be loaded. Nothing was changed; "
+                      << "restore it, or move it aside to start again from " << filename << ".\n";
+            return 1;
+        }
+    } else if (!loadData(roster, filename)) {
+        std::cout << "No saved data found. Starting with an empty system.\n";
+    }
+
+    // Recover any operations journaled after the snapshot was taken.
+    size_t replayed = 0;
+    for (const auto& segment : listJournalSegments(storage.journalBase)) {
+        replayed += replayJournal(roster, segment.second);
+    }
+    if (replayed > 0) {
+        std::cout << "Recovered " << replayed << " journaled change(s).\n";
+    }
+
+    if (argc > 1) {
+        std::cout.rdbuf(consoleBuffer);
+        std::cout.clear();
+        return runCommand(roster, argc, argv);
+    }
+
+    if (!openStorage(storage, roster)) {
+        return 1;
+    }
+    // Fold the recovered segments into a fresh snapshot right away. If
+    // that fails the segments stay and are replayed again next time.
+    if (replayed > 0 && !checkpointNow(storage, roster)) {
+        std::cerr << "Warning: Could not write a snapshot; the journal was kept.\n";
+    }
 
     // Main program loop with a menu.
     while (true) {
@@ -56,29 +341,107 @@ int main() {
 
         switch (choice) {
             case 1:
-                addStudent(students);
+                addStudent(roster, storage);
                 break;
             case 2:
-                addGrade(students);
+                addGrade(roster, storage);
                 break;
             case 3:
-                displayGrades(students);
+                displayGrades(roster);
                 break;
             case 4:
-                calculateAverage(students);
+                calculateAverage(roster);
                 break;
             case 5:
-                saveData(students, filename);
+                // Each change is applied only once its journal record is
+                // durable, so saving only confirms that. The snapshot is
+                // rewritten by the size-triggered checkpoint below and on
+                // exit, never per save.
+                if (!storage.journal.waitDurable(roster.journalSequence)) {
+                    std::cerr << "Error: The journal could not be written; recent changes may not be saved.\n";
+                    break;
+                }
                 std::cout << "Student data saved successfully.\n";
                 break;
             case 6:
                 std::cout << "Exiting program. Goodbye!\n";
                 // Save data on exit for a clean termination.
-                saveData(students, filename);
+                closeStorage(storage, roster);
                 return 0; // Exit the program.
+            case 7: {
+                std::string textFile;
+                std::cout << "Enter the text file to export to: ";
+                std::cin >> textFile;
+                saveData(roster, textFile);
+                std::cout << "Student data exported to " << textFile << ".\n";
+                break;
+            }
+            case 8: {
+                std::string textFile;
+                std::cout << "Enter the text file to import from: ";
+                std::cin >> textFile;
+                // The file is loaded on the side, so a missing or unreadable
+                // file leaves the current data alone.
+                Roster imported;
+                if (!loadData(imported, textFile)) {
+                    std::cerr << "Error: Could not import " << textFile << ". The current data was left unchanged.\n";
+                    break;
+                }
+                // Importing replaces everything currently in memory. The
+                // journal cannot express that, so a checkpoint records it;
+                // if the snapshot cannot be written the import is undone so
+                // memory keeps matching the snapshot and journal on disk.
+                imported.journalSequence = roster.journalSequence;
+                std::swap(roster, imported);
+                if (!checkpointNow(storage, roster)) {
+                    std::swap(roster, imported);
+                    std::cerr << "Error: Could not save the imported data. The import was undone and the journal was kept.\n";
+                    break;
+                }
+                break;
+            }
+            case 9:
+                displayStudentStats(roster);
+                break;
+            case 10:
+                displayRosterStats(roster);
+                break;
+            case 11: {
+                size_t k;
+                std::cout << "How many top students to list: ";
+                std::cin >> k;
+                if (!std::cin.fail()) reportTopStudents(roster, k);
+                break;
+            }
+            case 12: {
+                double percent;
+                std::cout << "Enter the percentile (0-100): ";
+                std::cin >> percent;
+                if (!std::cin.fail() && percent >= 0 && percent <= 100) {
+                    reportPercentiles(roster, {percent});
+                } else {
+                    std::cout << "Invalid percentile.\n";
+                }
+                break;
+            }
+            case 13:
+                reportHistogram(roster, 10);
+                break;
+            case 14: {
+                double threshold;
+                std::cout << "Enter the passing average: ";
+                std::cin >> threshold;
+                if (!std::cin.fail()) reportFailingStudents(roster, threshold);
+                break;
+            }
             default:
                 std::cout << "Invalid choice. Please try again.\n";
         }
+
+        // Keep the journal short by checkpointing once it grows large.
+        if (storage.journal.bytesWritten() >= JOURNAL_CHECKPOINT_BYTES) {
+            startCheckpoint(storage, roster);
+        }
     }
 
     return 0;
@@ -97,19 +460,28 @@ void displayMenu() {
     std::cout << "4. Calculate a student's average grade\n";
     std::cout << "5. Save data\n";
     std::cout << "6. Exit\n";
+    std::cout << "7. Export data to a text file\n";
+    std::cout << "8. Import data from a text file (replaces current data)\n";
+    std::cout << "9. Show a student's grade statistics\n";
+    std::cout << "10. Show class-wide grade statistics\n";
+    std::cout << "11. List top students by average\n";
+    std::cout << "12. Show a grade percentile\n";
+    std::cout << "13. Show a grade histogram\n";
+    std::cout << "14. List failing students\n";
 }
 
 /**
  * @brief Adds a new student to the system.
- * @param students A reference to the vector of Student objects.
+ * @param roster A reference to the roster of students.
+ * @param storage The storage the change is journaled to.
  */
-void addStudent(std::vector<Student>& students) {
+void addStudent(Roster& roster, Storage& storage) {
     std::string id, name;
     std::cout << "Enter student ID: ";
     std::cin >> id;
 
     // Check if a student with the same ID already exists.
-    if (findStudentById(students, id) != -1) {
+    if (findStudentById(roster, id) != -1) {
         std::cout << "Error: A student with this ID already exists.\n";
         return;
     }
@@ -118,21 +490,33 @@ void addStudent(std::vector<Student>& students) {
     std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // Clear buffer.
     std::getline(std::cin, name);
 
-    students.push_back({id, name, {}});
+    std::string payload = encodeUint32(static_cast<uint32_t>(id.size())) +
+                          encodeUint32(static_cast<uint32_t>(name.size())) + id + name;
+    if (!logOperation(roster, storage, JOURNAL_ADD_STUDENT, payload)) {
+        return;
+    }
+
+    Student student;
+    student.id = id;
+    student.name = name;
+    student.gradeOffset = roster.grades.size();
+    roster.students.push_back(student);
+    insertIntoIndex(roster, static_cast<int>(roster.students.size()) - 1);
     std::cout << "Student added successfully!\n";
 }
 
 /**
  * @brief Adds a new grade for an existing student.
- * @param students A reference to the vector of Student objects.
+ * @param roster A reference to the roster of students.
+ * @param storage The storage the change is journaled to.
  */
-void addGrade(std::vector<Student>& students) {
+void addGrade(Roster& roster, Storage& storage) {
     std::string id;
     double grade;
     std::cout << "Enter student ID to add a grade: ";
     std::cin >> id;
 
-    int index = findStudentById(students, id);
+    int index = findStudentById(roster, id);
     if (index == -1) {
         std::cout << "Error: Student not found.\n";
         return;
@@ -142,35 +526,42 @@ void addGrade(std::vector<Student>& students) {
     std::cin >> grade;
 
     // Input validation for the grade value.
-    if (std::cin.fail() || grade < 0 || grade > 100) {
+    if (std::cin.fail() || !isValidGrade(grade)) {
         std::cin.clear();
         std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
         std::cout << "Invalid grade. Please enter a value between 0 and 100.\n";
         return;
     }
 
-    students[index].grades.push_back(grade);
+    std::string payload = encodeUint32(static_cast<uint32_t>(id.size())) + id;
+    payload.append(reinterpret_cast<const char*>(&grade), sizeof(grade));
+    if (!logOperation(roster, storage, JOURNAL_ADD_GRADE, payload)) {
+        return;
+    }
+
+    appendGrade(roster, index, grade);
     std::cout << "Grade added successfully!\n";
 }
 
 /**
  * @brief Displays the grades for all students.
- * @param students A constant reference to the vector of Student objects.
+ * @param roster A constant reference to the roster of students.
  */
-void displayGrades(const std::vector<Student>& students) {
-    if (students.empty()) {
+void displayGrades(const Roster& roster) {
+    if (roster.students.empty()) {
         std::cout << "No students found.\n";
         return;
     }
 
     std::cout << "\n--- Student Grades ---\n";
-    for (const auto& student : students) {
+    for (const auto& student : roster.students) {
         std::cout << "ID: " << student.id << ", Name: " << student.name << "\n";
         std::cout << "Grades: ";
-        if (student.grades.empty()) {
+        GradeSpan grades = studentGrades(roster, student);
+        if (grades.empty()) {
             std::cout << "No grades recorded.\n";
         } else {
-            for (double grade : student.grades) {
+            for (double grade : grades) {
                 std::cout << grade << " ";
             }
             std::cout << "\n";
@@ -180,51 +571,400 @@ void displayGrades(const std::vector<Student>& students) {
 
 /**
  * @brief Calculates and displays the average grade for a specific student.
- * @param students A constant reference to the vector of Student objects.
+ * @param roster A constant reference to the roster of students.
  */
-void calculateAverage(const std::vector<Student>& students) {
+void calculateAverage(const Roster& roster) {
     std::string id;
     std::cout << "Enter student ID to calculate average: ";
     std::cin >> id;
 
-    int index = findStudentById(students, id);
+    int index = findStudentById(roster, id);
     if (index == -1) {
         std::cout << "Error: Student not found.\n";
         return;
     }
 
-    const auto& student = students[index];
-    if (student.grades.empty()) {
+    const auto& student = roster.students[index];
+    if (student.stats.count == 0) {
         std::cout << "No grades recorded for this student.\n";
         return;
     }
 
-    double sum = 0.0;
-    for (double grade : student.grades) {
-        sum += grade;
-    }
-    double average = sum / student.grades.size();
+    double average = statsAverage(student.stats);
 
     // Set precision for the average grade output.
     std::cout << std::fixed << std::setprecision(2);
     std::cout << "Average grade for " << student.name << " (ID: " << student.id << "): " << average << "\n";
 }
 
+/**
+ * @brief Displays the grade statistics of a specific student.
+ * @param roster A constant reference to the roster of students.
+ */
+void displayStudentStats(const Roster& roster) {
+    std::string id;
+    std::cout << "Enter student ID to show statistics: ";
+    std::cin >> id;
+
+    int index = findStudentById(roster, id);
+    if (index == -1) {
+        std::cout << "Error: Student not found.\n";
+        return;
+    }
+
+    const auto& student = roster.students[index];
+    std::cout << "Statistics for " << student.name << " (ID: " << student.id << "):\n";
+    printStats(student.stats);
+}
+
+/**
+ * @brief Displays the grade statistics of the whole roster.
+ * @param roster A constant reference to the roster of students.
+ */
+void displayRosterStats(const Roster& roster) {
+    std::cout << "Class statistics over " << roster.students.size() << " student(s):\n";
+    printStats(roster.totals);
+}
+
+/**
+ * @brief Runs a one-shot command given on the command line.
+ * Supported commands:
+ *   stats                   class-wide statistics
+ *   stats ID                statistics for one student
+ *   topk K                  the K students with the highest averages
+ *   percentile P [P ...]    roster-wide grade percentiles
+ *   histogram [BUCKETS]     histogram of every grade (default 10 buckets)
+ *   failing [THRESHOLD]     students averaging below THRESHOLD (default 60)
+ * @param roster A constant reference to the roster of students.
+ * @param argc The argument count passed to main.
+ * @param argv The arguments passed to main.
+ * @return The process exit code.
+ */
+int runCommand(const Roster& roster, int argc, char* argv[]) {
+    std::string command = argv[1];
+    if (command == "stats" && argc == 2) {
+        displayRosterStats(roster);
+        return 0;
+    }
+    if (command == "stats" && argc == 3) {
+        int index = findStudentById(roster, argv[2]);
+        if (index == -1) {
+            std::cerr << "Error: Student not found.\n";
+            return 1;
+        }
+        const auto& student = roster.students[index];
+        std::cout << "Statistics for " << student.name << " (ID: " << student.id << "):\n";
+        printStats(student.stats);
+        return 0;
+    }
+
+    if (command == "topk" && argc == 3) {
+        reportTopStudents(roster, std::strtoull(argv[2], nullptr, 10));
+        return 0;
+    }
+    if (command == "percentile" && argc >= 3) {
+        std::vector<double> percents;
+        for (int i = 2; i < argc; ++i) {
+            char* end = nullptr;
+            double p = std::strtod(argv[i], &end);
+            if (end == argv[i] || *end != '\0' || !(p >= 0 && p <= 100)) {
+                std::cerr << "Error: Percentiles must be between 0 and 100.\n";
+                return 1;
+            }
+            percents.push_back(p);
+        }
+        reportPercentiles(roster, percents);
+        return 0;
+    }
+    if (command == "histogram" && argc <= 3) {
+        int buckets = argc == 3 ? std::atoi(argv[2]) : 10;
+        if (buckets < 1 || buckets > 1000) {
+            std::cerr << "Error: Bucket count must be between 1 and 1000.\n";
+            return 1;
+        }
+        reportHistogram(roster, buckets);
+        return 0;
+    }
+    if (command == "failing" && argc <= 3) {
+        reportFailingStudents(roster, argc == 3 ? std::atof(argv[2]) : 60.0);
+        return 0;
+    }
+
+    std::cerr << "Usage: " << argv[0] << " [stats [ID] | topk K | percentile P [P ...] | histogram [BUCKETS] | failing [THRESHOLD]]\n";
+    std::cerr << "Run without arguments for the interactive menu.\n";
+    return 1;
+}
+
+// --- Analytics ---
+// Roster-wide queries. Per-student rankings read the running aggregates;
+// queries over individual grades make one or two sequential passes over
+// the grade buffer, split across threads for large rosters.
+
+/**
+ * @brief Chooses how many threads a pass over every grade should use.
+ * @param roster A constant reference to the roster of students.
+ * @return At least 1, and no more than one thread per
+ * ANALYTICS_GRADES_PER_THREAD grades.
+ */
+unsigned analyticsThreadCount(const Roster& roster) {
+    uint64_t wanted = roster.totals.count / ANALYTICS_GRADES_PER_THREAD + 1;
+    unsigned available = std::max(1u, std::thread::hardware_concurrency());
+    return static_cast<unsigned>(std::min<uint64_t>(wanted, available));
+}
+
+/**
+ * @brief Runs work(part, firstStudent, endStudent) over the students split
+ * into parts ranges holding roughly equal numbers of grades, one thread per
+ * range.
+ */
+template <typename Work>
+void forEachStudentRange(const Roster& roster, unsigned parts, Work work) {
+    std::vector<size_t> bounds(1, 0);
+    uint64_t perPart = roster.totals.count / parts + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < roster.students.size() && bounds.size() < parts; ++i) {
+        seen += roster.students[i].gradeCount;
+        if (seen >= perPart * bounds.size()) {
+            bounds.push_back(i + 1);
+        }
+    }
+    bounds.resize(parts + 1, roster.students.size());
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < parts; ++t) {
+        threads.emplace_back(work, t, bounds[t], bounds[t + 1]);
+    }
+    work(0u, bounds[0], bounds[1]);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+/**
+ * @brief Clamps a scaled grade to the bucket range [0, last]. The first
+ * test is written so NaN also goes to bucket 0 instead of reaching an
+ * undefined float-to-int conversion.
+ */
+inline double clampBucket(double bucket, double last) {
+    bucket = !(bucket >= 0.0) ? 0.0 : bucket;
+    return bucket > last ? last : bucket;
+}
+
+/**
+ * @brief Counts the grades of a span into buckets of equal width over
+ * [0, 100]; grades outside the range land in the first or last bucket.
+ * Bucket numbers are computed a block at a time in a branch-free loop the
+ * compiler can vectorize, then counted.
+ * @param grades The grades to count.
+ * @param bucketCount The number of buckets.
+ * @param counts The bucketCount counters to add to.
+ */
+void countGradeBuckets(GradeSpan grades, int bucketCount, uint64_t* counts) {
+    const size_t BLOCK = 256;
+    int32_t buckets[BLOCK];
+    double scale = bucketCount / 100.0;
+    double last = bucketCount - 1;
+    for (size_t start = 0; start < grades.size; start += BLOCK) {
+        size_t n = std::min(BLOCK, grades.size - start);
+        const double* data = grades.data + start;
+        for (size_t i = 0; i < n; ++i) {
+            buckets[i] = static_cast<int32_t>(clampBucket(data[i] * scale, last));
+        }
+        for (size_t i = 0; i < n; ++i) {
+            counts[buckets[i]]++;
+        }
+    }
+}
+
+/**
+ * @brief Builds a bucket histogram of every grade in the roster, with one
+ * set of counters per thread merged at the end.
+ */
+std::vector<uint64_t> histogramAllGrades(const Roster& roster, int bucketCount) {
+    unsigned parts = analyticsThreadCount(roster);
+    std::vector<std::vector<uint64_t>> partial(parts, std::vector<uint64_t>(bucketCount, 0));
+    forEachStudentRange(roster, parts, [&](unsigned part, size_t first, size_t end) {
+        for (size_t i = first; i < end; ++i) {
+            countGradeBuckets(studentGrades(roster, roster.students[i]), bucketCount, partial[part].data());
+        }
+    });
+
+    std::vector<uint64_t> counts(bucketCount, 0);
+    for (const auto& part : partial) {
+        for (int b = 0; b < bucketCount; ++b) {
+            counts[b] += part[b];
+        }
+    }
+    return counts;
+}
+
+/**
+ * @brief Prints how long a query took.
+ */
+void printQueryTime(std::chrono::steady_clock::time_point start) {
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::fixed << std::setprecision(3) << "Query time: " << ms << " ms\n";
+}
+
+/**
+ * @brief Lists the k students with the highest averages. Only the top k
+ * are sorted; the rest are split off with a selection.
+ * @param roster A constant reference to the roster of students.
+ * @param k The number of students to list.
+ */
+void reportTopStudents(const Roster& roster, size_t k) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::pair<double, size_t>> ranked;
+    ranked.reserve(roster.students.size());
+    for (size_t i = 0; i < roster.students.size(); ++i) {
+        if (roster.students[i].stats.count > 0) {
+            ranked.push_back({statsAverage(roster.students[i].stats), i});
+        }
+    }
+    auto better = [](const std::pair<double, size_t>& a, const std::pair<double, size_t>& b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    };
+    k = std::min(k, ranked.size());
+    if (k < ranked.size()) {
+        std::nth_element(ranked.begin(), ranked.begin() + k, ranked.end(), better);
+    }
+    std::sort(ranked.begin(), ranked.begin() + k, better);
+
+    std::cout << "\n--- Top " << k << " Students by Average ---\n";
+    std::cout << std::fixed << std::setprecision(2);
+    for (size_t r = 0; r < k; ++r) {
+        const Student& student = roster.students[ranked[r].second];
+        std::cout << r + 1 << ". " << student.name << " (ID: " << student.id << "): " << ranked[r].first << "\n";
+    }
+    printQueryTime(start);
+}
+
+/**
+ * @brief Prints roster-wide grade percentiles. The value at rank
+ * floor(p / 100 * (count - 1)) is found without sorting: one histogram
+ * pass locates the fine bucket that holds each rank, a second pass gathers
+ * just those buckets' grades, and nth_element picks the value.
+ * @param roster A constant reference to the roster of students.
+ * @param percents The percentiles to report, each in [0, 100].
+ */
+void reportPercentiles(const Roster& roster, const std::vector<double>& percents) {
+    auto start = std::chrono::steady_clock::now();
+    uint64_t total = roster.totals.count;
+    if (total == 0) {
+        std::cout << "No grades recorded.\n";
+        return;
+    }
+
+    const int FINE_BUCKETS = 4096;
+    std::vector<uint64_t> counts = histogramAllGrades(roster, FINE_BUCKETS);
+
+    // Find the bucket holding each requested rank, and the rank within it.
+    std::vector<uint64_t> bucketStart(FINE_BUCKETS + 1, 0);
+    for (int b = 0; b < FINE_BUCKETS; ++b) {
+        bucketStart[b + 1] = bucketStart[b] + counts[b];
+    }
+    std::vector<int> targetBucket;
+    std::vector<char> wanted(FINE_BUCKETS, 0);
+    for (double p : percents) {
+        uint64_t rank = static_cast<uint64_t>(std::floor(p / 100.0 * (total - 1)));
+        int bucket = static_cast<int>(std::upper_bound(bucketStart.begin(), bucketStart.end(), rank) - bucketStart.begin()) - 1;
+        targetBucket.push_back(bucket);
+        wanted[bucket] = 1;
+    }
+
+    // Gather the grades of the wanted buckets, per thread, in one pass.
+    unsigned parts = analyticsThreadCount(roster);
+    std::vector<std::vector<std::vector<double>>> gathered(parts, std::vector<std::vector<double>>(FINE_BUCKETS));
+    double scale = FINE_BUCKETS / 100.0;
+    double last = FINE_BUCKETS - 1;
+    forEachStudentRange(roster, parts, [&](unsigned part, size_t first, size_t end) {
+        for (size_t i = first; i < end; ++i) {
+            for (double grade : studentGrades(roster, roster.students[i])) {
+                int bucket = static_cast<int>(clampBucket(grade * scale, last));
+                if (wanted[bucket]) {
+                    gathered[part][bucket].push_back(grade);
+                }
+            }
+        }
+    });
+
+    std::cout << "\n--- Grade Percentiles (" << total << " grades) ---\n";
+    for (size_t i = 0; i < percents.size(); ++i) {
+        int bucket = targetBucket[i];
+        std::vector<double> values;
+        for (unsigned part = 0; part < parts; ++part) {
+            values.insert(values.end(), gathered[part][bucket].begin(), gathered[part][bucket].end());
+        }
+        uint64_t rank = static_cast<uint64_t>(std::floor(percents[i] / 100.0 * (total - 1))) - bucketStart[bucket];
+        std::nth_element(values.begin(), values.begin() + rank, values.end());
+        char label[32];
+        std::snprintf(label, sizeof(label), "P%g: ", percents[i]);
+        std::cout << label << std::fixed << std::setprecision(2) << values[rank] << "\n";
+    }
+    printQueryTime(start);
+}
+
+/**
+ * @brief Prints a histogram of every grade in the roster.
+ * @param roster A constant reference to the roster of students.
+ * @param bucketCount The number of equal-width buckets over [0, 100].
+ */
+void reportHistogram(const Roster& roster, int bucketCount) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<uint64_t> counts = histogramAllGrades(roster, bucketCount);
+    uint64_t largest = std::max<uint64_t>(1, *std::max_element(counts.begin(), counts.end()));
+
+    std::cout << "\n--- Grade Histogram (" << roster.totals.count << " grades) ---\n";
+    std::cout << std::fixed << std::setprecision(1);
+    double width = 100.0 / bucketCount;
+    for (int b = 0; b < bucketCount; ++b) {
+        std::cout << std::setw(5) << b * width << " - " << std::setw(5) << (b + 1) * width << ": "
+                  << std::setw(10) << counts[b] << " " << std::string(counts[b] * 40 / largest, '#') << "\n";
+    }
+    printQueryTime(start);
+}
+
+/**
+ * @brief Lists every student whose average is below a threshold.
+ * @param roster A constant reference to the roster of students.
+ * @param threshold The passing average.
+ */
+void reportFailingStudents(const Roster& roster, double threshold) {
+    auto start = std::chrono::steady_clock::now();
+    std::string report;
+    size_t failing = 0;
+    char line[64];
+    for (const auto& student : roster.students) {
+        double average = statsAverage(student.stats);
+        if (student.stats.count > 0 && average < threshold) {
+            std::snprintf(line, sizeof(line), "): %.2f\n", average);
+            report += student.name + " (ID: " + student.id + line;
+            failing++;
+        }
+    }
+
+    std::cout << "\n--- Students with an Average Below " << std::fixed << std::setprecision(2) << threshold << " ---\n";
+    std::cout << report;
+    std::cout << failing << " student(s) failing.\n";
+    printQueryTime(start);
+}
+
 /**
  * @brief Saves the student data to a file in a simple, comma-separated format.
- * @param students A constant reference to the vector of Student objects.
+ * @param roster A constant reference to the roster of students.
  * @param filename The name of the file to save to.
  */
-void saveData(const std::vector<Student>& students, const std::string& filename) {
+void saveData(const Roster& roster, const std::string& filename) {
     std::ofstream file(filename);
     if (!file.is_open()) {
         std::cerr << "Error: Could not open file for saving.\n";
         return;
     }
 
-    for (const auto& student : students) {
+    for (const auto& student : roster.students) {
         file << student.id << "," << student.name;
-        for (double grade : student.grades) {
+        for (double grade : studentGrades(roster, student)) {
             file << "," << grade;
         }
         file << "\n";
@@ -233,65 +973,1001 @@ void saveData(const std::vector<Student>& students, const std::string& filename)
 }
 
 /**
- * @brief Loads student data from a file and populates the vector.
- * @param students A reference to the vector of Student objects.
- * @param filename The name of the file to load from.
+ * @brief Parses one line of the text format ("id,name,grade,grade,...").
+ * Fields are sliced out of the line without copying until they are stored.
+ * @param line The line, without its newline.
+ * @param student The student to fill in.
+ * @param grades The grade column to append the student's grades to; the
+ * student's offset and count are set relative to it.
+ * @return The number of grade fields that were not valid grades.
  */
-void loadData(std::vector<Student>& students, const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cout << "No saved data found. Starting with an empty system.\n";
-        return;
+size_t parseStudentLine(std::string_view line, Student& student, std::vector<double>& grades) {
+    student.gradeOffset = grades.size();
+    size_t badGrades = 0;
+    int part_count = 0;
+    while (true) {
+        size_t pos = line.find(',');
+        std::string_view part = line.substr(0, pos);
+        if (part_count == 0) {
+            student.id = std::string(part);
+        } else if (part_count == 1) {
+            student.name = std::string(part);
+        } else if (!part.empty()) {
+            double grade = 0.0;
+            auto result = std::from_chars(part.data(), part.data() + part.size(), grade);
+            if (result.ec == std::errc() && result.ptr == part.data() + part.size() && isValidGrade(grade)) {
+                grades.push_back(grade);
+            } else {
+                badGrades++;
+            }
+        }
+        if (pos == std::string_view::npos) {
+            break;
+        }
+        line.remove_prefix(pos + 1);
+        part_count++;
     }
+    student.gradeCount = static_cast<uint32_t>(grades.size() - student.gradeOffset);
+    student.gradeCapacity = student.gradeCount;
+    return badGrades;
+}
 
-    std::string line;
-    while (std::getline(file, line)) {
+/**
+ * @brief Parses a block of whole lines into students.
+ * @param text The block; it must start at a line boundary.
+ * @param students The vector to append the parsed students to.
+ * @param grades The block's own grade column.
+ * @return The number of grade fields that were not valid grades.
+ */
+size_t parseStudentBlock(std::string_view text, std::vector<Student>& students, std::vector<double>& grades) {
+    size_t badGrades = 0;
+    while (!text.empty()) {
+        size_t end = text.find('\n');
+        std::string_view line = text.substr(0, end);
+        text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
         if (line.empty()) continue;
 
         Student student;
-        std::string part;
-        size_t pos = 0;
-        int part_count = 0;
-
-        while ((pos = line.find(',')) != std::string::npos) {
-            part = line.substr(0, pos);
-            if (part_count == 0) {
-                student.id = part;
-            } else if (part_count == 1) {
-                student.name = part;
-            } else {
-                student.grades.push_back(std::stod(part));
+        badGrades += parseStudentLine(line, student, grades);
+        students.push_back(std::move(student));
+    }
+    return badGrades;
+}
+
+/**
+ * @brief Loads student data from a file and populates the roster.
+ * The file is memory-mapped and parsed in place. Large files are split at
+ * line boundaries into one block per thread; the blocks are appended in
+ * file order and the index is then built in a single pass.
+ * @param roster A reference to the roster of students.
+ * @param filename The name of the file to load from.
+ * @return false if the file does not exist or cannot be read; the roster
+ * is then left unchanged.
+ */
+bool loadData(Roster& roster, const std::string& filename) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0) {
+        close(fd);
+        std::cerr << "Error: Could not read " << filename << ".\n";
+        return false;
+    }
+    size_t size = static_cast<size_t>(fileStat.st_size);
+    if (size == 0) {
+        close(fd);
+        std::cout << "Student data loaded successfully.\n";
+        return true;
+    }
+
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Error: Could not map " << filename << ".\n";
+        return false;
+    }
+    madvise(mapped, size, MADV_SEQUENTIAL);
+    std::string_view text(static_cast<const char*>(mapped), size);
+
+    // Cut the file into blocks that each end just after a newline.
+    size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+    threadCount = std::min(threadCount, size / PARALLEL_PARSE_MIN_BLOCK + 1);
+    std::vector<std::string_view> blocks;
+    size_t start = 0;
+    for (size_t t = 1; t <= threadCount && start < size; ++t) {
+        size_t end = t == threadCount ? size : std::max(start, size * t / threadCount);
+        end = text.find('\n', end);
+        end = end == std::string_view::npos ? size : end + 1;
+        blocks.push_back(text.substr(start, end - start));
+        start = end;
+    }
+
+    std::vector<std::vector<Student>> parsed(blocks.size());
+    std::vector<std::vector<double>> parsedGrades(blocks.size());
+    std::vector<size_t> badGrades(blocks.size(), 0);
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < blocks.size(); ++i) {
+        threads.emplace_back([&, i]() { badGrades[i] = parseStudentBlock(blocks[i], parsed[i], parsedGrades[i]); });
+    }
+    badGrades[0] = parseStudentBlock(blocks[0], parsed[0], parsedGrades[0]);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    munmap(mapped, size);
+
+    size_t total = roster.students.size();
+    size_t totalGrades = roster.grades.size();
+    for (size_t i = 0; i < parsed.size(); ++i) {
+        total += parsed[i].size();
+        totalGrades += parsedGrades[i].size();
+    }
+    roster.students.reserve(total);
+    roster.grades.reserve(totalGrades);
+    reserveIndex(roster.index, total);
+
+    size_t skipped = 0;
+    for (size_t i = 0; i < parsed.size(); ++i) {
+        skipped += badGrades[i];
+        uint64_t base = roster.grades.size();
+        roster.grades.insert(roster.grades.end(), parsedGrades[i].begin(), parsedGrades[i].end());
+        for (auto& student : parsed[i]) {
+            student.gradeOffset += base;
+            roster.students.push_back(std::move(student));
+            insertIntoIndex(roster, static_cast<int>(roster.students.size()) - 1);
+        }
+    }
+
+    rebuildStats(roster);
+
+    if (skipped > 0) {
+        std::cerr << "Warning: Skipped " << skipped << " invalid grade(s) in " << filename
+                  << ". Grades must be between 0 and 100.\n";
+    }
+    std::cout << "Student data loaded successfully.\n";
+    return true;
+}
+
+/**
+ * @brief Rounds a byte offset up to the next multiple of 8.
+ */
+static uint64_t alignTo8(uint64_t offset) {
+    return (offset + 7) & ~uint64_t(7);
+}
+
+/**
+ * @brief Serializes the roster into a binary snapshot (see SnapshotHeader).
+ * This only copies memory, so it is cheap enough to run before handing the
+ * result to a background writer.
+ * @param roster A constant reference to the roster of students.
+ * @return The complete snapshot file contents.
+ */
+std::vector<char> buildSnapshot(const Roster& roster) {
+    SnapshotHeader header = {};
+    std::copy(SNAPSHOT_MAGIC, SNAPSHOT_MAGIC + 8, header.magic);
+    header.version = SNAPSHOT_VERSION;
+    header.byteOrder = SNAPSHOT_BYTE_ORDER;
+    header.studentCount = roster.students.size();
+    for (const auto& student : roster.students) {
+        header.gradeCount += student.gradeCount;
+        header.stringBytes += student.id.size() + student.name.size();
+    }
+    header.studentsOffset = sizeof(SnapshotHeader);
+    header.gradeOffsetsOffset = alignTo8(header.studentsOffset + header.studentCount * sizeof(SnapshotStudent));
+    header.gradesOffset = header.gradeOffsetsOffset + (header.studentCount + 1) * sizeof(uint64_t);
+    header.stringsOffset = header.gradesOffset + header.gradeCount * sizeof(double);
+    header.journalSequence = roster.journalSequence;
+
+    std::vector<char> buffer(header.stringsOffset + header.stringBytes, 0);
+    std::memcpy(buffer.data(), &header, sizeof(header));
+    SnapshotStudent* records = reinterpret_cast<SnapshotStudent*>(buffer.data() + header.studentsOffset);
+    uint64_t* gradeOffsets = reinterpret_cast<uint64_t*>(buffer.data() + header.gradeOffsetsOffset);
+    double* grades = reinterpret_cast<double*>(buffer.data() + header.gradesOffset);
+    char* strings = buffer.data() + header.stringsOffset;
+
+    uint64_t gradePos = 0;
+    uint64_t stringPos = 0;
+    for (size_t i = 0; i < roster.students.size(); ++i) {
+        const Student& student = roster.students[i];
+        records[i] = {stringPos, static_cast<uint32_t>(student.id.size()), static_cast<uint32_t>(student.name.size())};
+        std::memcpy(strings + stringPos, student.id.data(), student.id.size());
+        stringPos += student.id.size();
+        std::memcpy(strings + stringPos, student.name.data(), student.name.size());
+        stringPos += student.name.size();
+
+        gradeOffsets[i] = gradePos;
+        GradeSpan span = studentGrades(roster, student);
+        std::copy(span.begin(), span.end(), grades + gradePos);
+        gradePos += span.size;
+    }
+    gradeOffsets[roster.students.size()] = gradePos;
+    return buffer;
+}
+
+/**
+ * @brief Writes a snapshot file. It is written to a temporary file and
+ * renamed over the old one, so a failed save never leaves a half-written
+ * snapshot behind.
+ * @param snapshot The contents from buildSnapshot().
+ * @param filename The name of the snapshot file.
+ * @return true if the snapshot was written completely.
+ */
+bool writeSnapshotFile(const std::vector<char>& snapshot, const std::string& filename) {
+    std::string tempFilename = filename + ".tmp";
+    int fd = open(tempFilename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << "Error: Could not open file for saving.\n";
+        return false;
+    }
+    bool ok = writeAll(fd, snapshot.data(), snapshot.size()) && fsync(fd) == 0;
+    ok = close(fd) == 0 && ok;
+    if (!ok || rename(tempFilename.c_str(), filename.c_str()) != 0) {
+        std::cerr << "Error: Could not write " << filename << ".\n";
+        unlink(tempFilename.c_str());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Loads a binary snapshot by mapping it and copying each section
+ * straight into the roster; nothing is parsed.
+ * @param roster A reference to the roster of students (expected empty).
+ * @param filename The name of the snapshot file.
+ * @return false if there is no snapshot or it is not valid.
+ */
+bool loadSnapshot(Roster& roster, const std::string& filename) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || static_cast<size_t>(fileStat.st_size) < SNAPSHOT_V1_HEADER_SIZE) {
+        close(fd);
+        std::cerr << "Error: " << filename << " is not a valid snapshot.\n";
+        return false;
+    }
+    size_t size = static_cast<size_t>(fileStat.st_size);
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Error: Could not map " << filename << ".\n";
+        return false;
+    }
+    const char* base = static_cast<const char*>(mapped);
+
+    SnapshotHeader header = {};
+    std::memcpy(&header, base, SNAPSHOT_V1_HEADER_SIZE);
+    size_t headerSize = header.version >= 2 ? sizeof(SnapshotHeader) : SNAPSHOT_V1_HEADER_SIZE;
+    if (header.version >= 2 && size >= headerSize) {
+        std::memcpy(&header, base, headerSize);
+    }
+    // Every field is untrusted, so each section is checked as offset <= size
+    // first and then as a count that fits in what is left: no sum of file
+    // values is formed before its terms are known to be bounded by size.
+    bool valid = std::equal(SNAPSHOT_MAGIC, SNAPSHOT_MAGIC + 8, header.magic) &&
+                 header.version >= 1 && header.version <= SNAPSHOT_VERSION &&
+                 header.byteOrder == SNAPSHOT_BYTE_ORDER && size >= headerSize &&
+                 header.studentsOffset >= headerSize && header.studentsOffset <= size &&
+                 header.studentCount <= (size - header.studentsOffset) / sizeof(SnapshotStudent) &&
+                 header.gradeOffsetsOffset <= size &&
+                 header.gradeOffsetsOffset >= header.studentsOffset + header.studentCount * sizeof(SnapshotStudent) &&
+                 header.studentCount < (size - header.gradeOffsetsOffset) / sizeof(uint64_t) &&
+                 header.gradesOffset <= size &&
+                 header.gradesOffset >= header.gradeOffsetsOffset + (header.studentCount + 1) * sizeof(uint64_t) &&
+                 header.gradeCount <= (size - header.gradesOffset) / sizeof(double) &&
+                 header.stringsOffset <= size &&
+                 header.stringsOffset >= header.gradesOffset + header.gradeCount * sizeof(double) &&
+                 header.stringBytes <= size - header.stringsOffset &&
+                 header.studentsOffset % 8 == 0 && header.gradeOffsetsOffset % 8 == 0 && header.gradesOffset % 8 == 0;
+
+    // Sections are only located once their offsets are known to be in the file.
+    const SnapshotStudent* records = nullptr;
+    const uint64_t* gradeOffsets = nullptr;
+    const double* grades = nullptr;
+    const char* strings = nullptr;
+    if (valid) {
+        records = reinterpret_cast<const SnapshotStudent*>(base + header.studentsOffset);
+        gradeOffsets = reinterpret_cast<const uint64_t*>(base + header.gradeOffsetsOffset);
+        grades = reinterpret_cast<const double*>(base + header.gradesOffset);
+        strings = base + header.stringsOffset;
+
+        valid = gradeOffsets[header.studentCount] == header.gradeCount;
+        for (uint64_t i = 0; valid && i < header.studentCount; ++i) {
+            valid = gradeOffsets[i] <= gradeOffsets[i + 1] &&
+                    gradeOffsets[i + 1] - gradeOffsets[i] <= UINT32_MAX &&
+                    records[i].stringOffset <= header.stringBytes &&
+                    records[i].idLength <= header.stringBytes - records[i].stringOffset &&
+                    records[i].nameLength <= header.stringBytes - records[i].stringOffset - records[i].idLength;
+        }
+    }
+    if (!valid) {
+        munmap(mapped, size);
+        std::cerr << "Error: " << filename << " is not a valid snapshot.\n";
+        return false;
+    }
+
+    size_t badGrades = std::count_if(grades, grades + header.gradeCount, [](double grade) { return !isValidGrade(grade); });
+
+    roster.journalSequence = header.journalSequence;
+    // The grade column is already in roster layout: copy it in one go,
+    // unless invalid grades have to be dropped from it.
+    if (badGrades == 0) {
+        roster.grades.assign(grades, grades + header.gradeCount);
+    } else {
+        roster.grades.reserve(header.gradeCount - badGrades);
+    }
+    roster.unusedGrades = 0;
+    roster.students.resize(header.studentCount);
+    reserveIndex(roster.index, header.studentCount);
+    for (uint64_t i = 0; i < header.studentCount; ++i) {
+        Student& student = roster.students[i];
+        const char* text = strings + records[i].stringOffset;
+        student.id.assign(text, records[i].idLength);
+        student.name.assign(text + records[i].idLength, records[i].nameLength);
+        if (badGrades == 0) {
+            student.gradeOffset = gradeOffsets[i];
+        } else {
+            student.gradeOffset = roster.grades.size();
+            std::copy_if(grades + gradeOffsets[i], grades + gradeOffsets[i + 1], std::back_inserter(roster.grades), isValidGrade);
+        }
+        student.gradeCount = static_cast<uint32_t>((badGrades == 0 ? gradeOffsets[i + 1] : roster.grades.size()) - student.gradeOffset);
+        student.gradeCapacity = student.gradeCount;
+        insertIntoIndex(roster, static_cast<int>(i));
+    }
+    munmap(mapped, size);
+    rebuildStats(roster);
+    if (badGrades > 0) {
+        std::cerr << "Warning: Skipped " << badGrades << " invalid grade(s) in " << filename
+                  << ". Grades must be between 0 and 100.\n";
+    }
+    std::cout << "Student data loaded successfully.\n";
+    return true;
+}
+
+/**
+ * @brief Checks that a grade is a percentage. NaN fails the comparisons, so
+ * it is rejected along with infinities and out-of-range values.
+ * @param grade The grade to check.
+ * @return true if the grade is in [0, 100].
+ */
+bool isValidGrade(double grade) {
+    return grade >= 0.0 && grade <= 100.0;
+}
+
+/**
+ * @brief Returns a view of one student's grades in the shared buffer.
+ * @param roster A constant reference to the roster of students.
+ * @param student The student, which must belong to roster.
+ * @return The student's grades, in the order they were added.
+ */
+GradeSpan studentGrades(const Roster& roster, const Student& student) {
+    return {roster.grades.data() + student.gradeOffset, student.gradeCount};
+}
+
+/**
+ * @brief Appends a grade to a student's range, growing the range if it is
+ * full. A range at the end of the buffer grows in place; any other range
+ * moves to the end with double the capacity, so appends stay amortized O(1).
+ * @param roster A reference to the roster of students.
+ * @param position The position of the student in roster.students.
+ * @param grade The grade to append.
+ */
+void appendGrade(Roster& roster, int position, double grade) {
+    Student& student = roster.students[position];
+    if (student.gradeCount == student.gradeCapacity) {
+        uint32_t newCapacity = std::max<uint32_t>(4, student.gradeCapacity * 2);
+        if (student.gradeOffset + student.gradeCapacity == roster.grades.size()) {
+            roster.grades.resize(student.gradeOffset + newCapacity);
+        } else {
+            uint64_t newOffset = roster.grades.size();
+            roster.grades.resize(newOffset + newCapacity);
+            std::copy_n(roster.grades.begin() + student.gradeOffset, student.gradeCount,
+                        roster.grades.begin() + newOffset);
+            roster.unusedGrades += student.gradeCapacity;
+            student.gradeOffset = newOffset;
+        }
+        roster.unusedGrades += newCapacity - student.gradeCount;
+        student.gradeCapacity = newCapacity;
+    }
+    roster.grades[student.gradeOffset + student.gradeCount] = grade;
+    student.gradeCount++;
+    roster.unusedGrades--;
+    addToStats(student.stats, grade);
+    addToStats(roster.totals, grade);
+
+    // Reclaim abandoned ranges and spare capacity once they outweigh live grades.
+    if (roster.unusedGrades > 1024 && roster.unusedGrades > roster.grades.size() / 2) {
+        compactGrades(roster);
+    }
+}
+
+/**
+ * @brief Adds one grade to a set of running aggregates.
+ * @param stats The aggregates to update.
+ * @param grade The grade being added.
+ */
+void addToStats(GradeStats& stats, double grade) {
+    if (stats.count == 0 || grade < stats.min) stats.min = grade;
+    if (stats.count == 0 || grade > stats.max) stats.max = grade;
+    stats.count++;
+    stats.sum += grade;
+    stats.sumOfSquares += grade * grade;
+}
+
+/**
+ * @brief Returns the mean of the aggregated grades (0 if there are none).
+ */
+double statsAverage(const GradeStats& stats) {
+    return stats.count == 0 ? 0.0 : stats.sum / stats.count;
+}
+
+/**
+ * @brief Returns the population standard deviation of the aggregated grades.
+ */
+double statsStandardDeviation(const GradeStats& stats) {
+    if (stats.count == 0) return 0.0;
+    double mean = statsAverage(stats);
+    double variance = stats.sumOfSquares / stats.count - mean * mean;
+    // Rounding can push a zero variance slightly negative.
+    return std::sqrt(std::max(0.0, variance));
+}
+
+/**
+ * @brief Prints a set of aggregates on one line.
+ * @param stats The aggregates to print.
+ */
+void printStats(const GradeStats& stats) {
+    if (stats.count == 0) {
+        std::cout << "No grades recorded.\n";
+        return;
+    }
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Grades: " << stats.count << ", Average: " << statsAverage(stats)
+              << ", Std. dev.: " << statsStandardDeviation(stats) << ", Min: " << stats.min
+              << ", Max: " << stats.max << "\n";
+}
+
+/**
+ * @brief Recomputes every student's aggregates and the roster totals in a
+ * single pass over the grade buffer. Used once after loading.
+ * @param roster A reference to the roster of students.
+ */
+void rebuildStats(Roster& roster) {
+    roster.totals = GradeStats();
+    for (auto& student : roster.students) {
+        student.stats = GradeStats();
+        for (double grade : studentGrades(roster, student)) {
+            addToStats(student.stats, grade);
+        }
+        if (student.stats.count == 0) continue;
+        // Merge into the totals without revisiting the grades.
+        GradeStats& totals = roster.totals;
+        if (totals.count == 0 || student.stats.min < totals.min) totals.min = student.stats.min;
+        if (totals.count == 0 || student.stats.max > totals.max) totals.max = student.stats.max;
+        totals.count += student.stats.count;
+        totals.sum += student.stats.sum;
+        totals.sumOfSquares += student.stats.sumOfSquares;
+    }
+}
+
+/**
+ * @brief Rewrites the grade buffer so that students' grades are stored
+ * back to back in roster order, with no spare capacity.
+ * @param roster A reference to the roster of students.
+ */
+void compactGrades(Roster& roster) {
+    std::vector<double> compacted;
+    compacted.reserve(roster.grades.size() - roster.unusedGrades);
+    for (auto& student : roster.students) {
+        GradeSpan span = studentGrades(roster, student);
+        student.gradeOffset = compacted.size();
+        student.gradeCapacity = student.gradeCount;
+        compacted.insert(compacted.end(), span.begin(), span.end());
+    }
+    roster.grades = std::move(compacted);
+    roster.unusedGrades = 0;
+}
+
+/**
+ * @brief Encodes a 32-bit value in native byte order for a journal payload.
+ */
+std::string encodeUint32(uint32_t value) {
+    return std::string(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+/**
+ * @brief Writes a whole buffer to a file descriptor, retrying short writes.
+ * @return true if every byte was written.
+ */
+bool writeAll(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(fd, data, length);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return false;
+        data += written;
+        length -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+/**
+ * @brief Flushes the directory holding a file, so that a file just created
+ * or renamed there survives a crash.
+ */
+void syncDirectoryOf(const std::string& path) {
+    size_t slash = path.rfind('/');
+    std::string directory = slash == std::string::npos ? "." : path.substr(0, slash + 1);
+    int fd = open(directory.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+}
+
+/**
+ * @brief Checksums a journal record (FNV-1a over its sequence, type and payload).
+ */
+uint32_t journalChecksum(uint64_t sequence, uint8_t type, const char* payload, size_t length) {
+    uint32_t hash = 2166136261u;
+    auto mix = [&hash](const char* data, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 16777619u;
+        }
+    };
+    mix(reinterpret_cast<const char*>(&sequence), sizeof(sequence));
+    mix(reinterpret_cast<const char*>(&type), sizeof(type));
+    mix(payload, length);
+    return hash;
+}
+
+/**
+ * @brief Returns the file name of a journal segment.
+ */
+std::string journalSegmentPath(const std::string& journalBase, uint64_t segment) {
+    char suffix[32];
+    std::snprintf(suffix, sizeof(suffix), ".%06llu", static_cast<unsigned long long>(segment));
+    return journalBase + suffix;
+}
+
+Journal::~Journal() {
+    close();
+}
+
+/**
+ * @brief Opens (or creates) a journal segment for appending and starts the
+ * background flusher.
+ * @param path The segment file.
+ * @param firstSequence The sequence number of the first record to append.
+ * @return false if the file could not be opened.
+ */
+bool Journal::open(const std::string& path, uint64_t firstSequence) {
+    close();
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    nextSequence = firstSequence;
+    appendedSequence = durableSequence = firstSequence - 1;
+    bytes = 0;
+    stopping = false;
+    failed = false;
+    flusher = std::thread(&Journal::flushLoop, this);
+    return true;
+}
+
+/**
+ * @brief Queues a record for the next group commit.
+ * @param type JOURNAL_ADD_STUDENT or JOURNAL_ADD_GRADE.
+ * @param payload The encoded operation.
+ * @return The record's sequence number, to pass to waitDurable(), or 0 if
+ * the journal has failed and must be reopened before it takes new records.
+ */
+uint64_t Journal::append(uint8_t type, const std::string& payload) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (failed || fd < 0) {
+        return 0;
+    }
+    JournalRecordHeader header = {};
+    header.payloadLength = static_cast<uint32_t>(payload.size());
+    header.sequence = nextSequence++;
+    header.type = type;
+    header.checksum = journalChecksum(header.sequence, type, payload.data(), payload.size());
+    pending.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    pending += payload;
+    appendedSequence = header.sequence;
+    wake.notify_one();
+    return header.sequence;
+}
+
+/**
+ * @brief Blocks until a record, and every record before it, is on disk.
+ * @return false if the journal could not be written.
+ */
+bool Journal::waitDurable(uint64_t sequence) {
+    std::unique_lock<std::mutex> lock(mutex);
+    durable.wait(lock, [&] { return durableSequence >= sequence || failed || fd < 0; });
+    return durableSequence >= sequence;
+}
+
+/**
+ * @brief The last sequence number handed out, including records that were
+ * dropped after a failure. A new segment must start after it.
+ */
+uint64_t Journal::lastSequence() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return nextSequence - 1;
+}
+
+/**
+ * @brief Writes out anything still queued, then stops the flusher and
+ * closes the segment.
+ */
+void Journal::close() {
+    if (flusher.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        flusher.join();
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+/**
+ * @brief The group commit loop: takes the whole pending batch, writes it
+ * with one write() and makes it durable with one fdatasync().
+ */
+void Journal::flushLoop() {
+    std::string batch;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [&] { return !pending.empty() || stopping; });
+        if (pending.empty()) {
+            return;
+        }
+        batch.swap(pending);
+        uint64_t batchSequence = appendedSequence;
+        lock.unlock();
+
+        bool ok = writeAll(fd, batch.data(), batch.size()) && fdatasync(fd) == 0;
+
+        lock.lock();
+        if (ok) {
+            bytes += batch.size();
+            durableSequence = batchSequence;
+        } else if (!failed) {
+            // Drop everything not yet durable, including records queued
+            // behind this batch, and cut the segment back to the last
+            // synced record so a partial write cannot be replayed.
+            failed = true;
+            pending.clear();
+            if (ftruncate(fd, static_cast<off_t>(bytes.load())) != 0 || fdatasync(fd) != 0) {
+                std::cerr << "Warning: Could not discard an unsaved journal record; it may reappear on restart.\n";
             }
-            line.erase(0, pos + 1);
-            part_count++;
-        }
-        // Handle the last part (the last grade or just the name/id).
-        if (!line.empty()) {
-            if (part_count == 0) { // Only ID
-                student.id = line;
-            } else if (part_count == 1) { // ID and Name
-                student.name = line;
-            } else { // At least one grade
-                student.grades.push_back(std::stod(line));
+        }
+        batch.clear();
+        durable.notify_all();
+    }
+}
+
+/**
+ * @brief Lists the journal segments on disk, oldest first.
+ * @param journalBase The segment name without its numeric suffix.
+ * @return (segment number, path) pairs.
+ */
+std::vector<std::pair<uint64_t, std::string>> listJournalSegments(const std::string& journalBase) {
+    size_t slash = journalBase.rfind('/');
+    std::string directory = slash == std::string::npos ? "." : journalBase.substr(0, slash + 1);
+    std::string prefix = (slash == std::string::npos ? journalBase : journalBase.substr(slash + 1)) + ".";
+
+    std::vector<std::pair<uint64_t, std::string>> segments;
+    DIR* dir = opendir(directory.c_str());
+    if (dir == nullptr) {
+        return segments;
+    }
+    while (dirent* entry = readdir(dir)) {
+        std::string_view name = entry->d_name;
+        if (name.size() <= prefix.size() || name.substr(0, prefix.size()) != prefix) continue;
+        std::string_view digits = name.substr(prefix.size());
+        uint64_t number = 0;
+        auto result = std::from_chars(digits.data(), digits.data() + digits.size(), number);
+        if (result.ec != std::errc() || result.ptr != digits.data() + digits.size()) continue;
+        segments.push_back({number, journalSegmentPath(journalBase, number)});
+    }
+    closedir(dir);
+    std::sort(segments.begin(), segments.end());
+    return segments;
+}
+
+/**
+ * @brief Applies the records of one journal segment that are newer than
+ * the roster. Replay stops at the first incomplete or corrupt record,
+ * which can only be the tail of a write interrupted by a crash.
+ * @param roster A reference to the roster of students.
+ * @param path The segment file.
+ * @return The number of records applied.
+ */
+size_t replayJournal(Roster& roster, const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0) {
+        close(fd);
+        return 0;
+    }
+    size_t size = static_cast<size_t>(fileStat.st_size);
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Error: Could not map " << path << ".\n";
+        return 0;
+    }
+    const char* data = static_cast<const char*>(mapped);
+
+    size_t applied = 0;
+    size_t pos = 0;
+    while (size - pos >= sizeof(JournalRecordHeader)) {
+        JournalRecordHeader header;
+        std::memcpy(&header, data + pos, sizeof(header));
+        const char* payload = data + pos + sizeof(header);
+        if (header.payloadLength > size - pos - sizeof(header) ||
+            header.checksum != journalChecksum(header.sequence, header.type, payload, header.payloadLength)) {
+            std::cerr << "Warning: Ignoring a torn record at the end of " << path << ".\n";
+            break;
+        }
+        pos += sizeof(header) + header.payloadLength;
+        if (header.sequence <= roster.journalSequence) continue;
+
+        uint32_t idLength = 0;
+        if (header.payloadLength >= sizeof(idLength)) {
+            std::memcpy(&idLength, payload, sizeof(idLength));
+        }
+        if (header.type == JOURNAL_ADD_STUDENT && header.payloadLength >= 8) {
+            uint32_t nameLength;
+            std::memcpy(&nameLength, payload + 4, sizeof(nameLength));
+            if (uint64_t(8) + idLength + nameLength == header.payloadLength) {
+                Student student;
+                student.id.assign(payload + 8, idLength);
+                student.name.assign(payload + 8 + idLength, nameLength);
+                student.gradeOffset = roster.grades.size();
+                if (findStudentById(roster, student.id) == -1) {
+                    roster.students.push_back(student);
+                    insertIntoIndex(roster, static_cast<int>(roster.students.size()) - 1);
+                }
+            }
+        } else if (header.type == JOURNAL_ADD_GRADE && uint64_t(4) + idLength + sizeof(double) == header.payloadLength) {
+            double grade;
+            std::memcpy(&grade, payload + 4 + idLength, sizeof(grade));
+            int index = findStudentById(roster, std::string(payload + 4, idLength));
+            if (index != -1 && isValidGrade(grade)) {
+                appendGrade(roster, index, grade);
             }
         }
-        students.push_back(student);
+        roster.journalSequence = header.sequence;
+        applied++;
     }
-    file.close();
-    std::cout << "Student data loaded successfully.\n";
+    munmap(mapped, size);
+    return applied;
+}
+
+/**
+ * @brief Opens a new journal segment after any already on disk.
+ * @param storage The storage to open.
+ * @param roster The roster, which determines the next sequence number.
+ * @return false if the journal could not be created.
+ */
+bool openStorage(Storage& storage, const Roster& roster) {
+    auto segments = listJournalSegments(storage.journalBase);
+    storage.activeSegment = segments.empty() ? 1 : segments.back().first + 1;
+    std::string path = journalSegmentPath(storage.journalBase, storage.activeSegment);
+    // Never reuse the sequence of a record dropped after a failed write.
+    uint64_t firstSequence = std::max(roster.journalSequence, storage.journal.lastSequence()) + 1;
+    if (!storage.journal.open(path, firstSequence)) {
+        std::cerr << "Error: Could not open journal " << path << ".\n";
+        return false;
+    }
+    syncDirectoryOf(path);
+    return true;
+}
+
+/**
+ * @brief Journals an operation and waits until it is durable. The caller
+ * applies the operation to the roster only if this succeeds. A journal
+ * that failed earlier is replaced by a new segment first.
+ * @return false if the journal could not be written.
+ */
+bool logOperation(Roster& roster, Storage& storage, uint8_t type, const std::string& payload) {
+    uint64_t sequence = storage.journal.append(type, payload);
+    if (sequence == 0) {
+        storage.journal.close();
+        if (openStorage(storage, roster)) {
+            sequence = storage.journal.append(type, payload);
+        }
+    }
+    if (sequence == 0 || !storage.journal.waitDurable(sequence)) {
+        std::cerr << "Error: Could not write to the journal; the change was not saved.\n";
+        return false;
+    }
+    roster.journalSequence = sequence;
+    return true;
+}
+
+/**
+ * @brief Deletes every journal segment up to and including a number.
+ */
+void removeJournalSegments(const std::string& journalBase, uint64_t lastSegment) {
+    for (const auto& segment : listJournalSegments(journalBase)) {
+        if (segment.first <= lastSegment) {
+            unlink(segment.second.c_str());
+        }
+    }
+}
+
+/**
+ * @brief Starts a checkpoint. New operations go to a fresh journal segment
+ * while the roster as of now is written to the snapshot in the background;
+ * once the snapshot is durable, the segments it covers are deleted. If the
+ * write fails the segments stay, and the next checkpoint covers them too.
+ * @param storage The storage to checkpoint.
+ * @param roster The roster to snapshot.
+ */
+void startCheckpoint(Storage& storage, const Roster& roster) {
+    if (storage.checkpointer.joinable()) {
+        storage.checkpointer.join();
+    }
+
+    uint64_t coveredSegment = storage.activeSegment;
+    storage.journal.close();
+    if (!openStorage(storage, roster)) {
+        storage.checkpointFailed = true;
+        return;
+    }
+
+    std::vector<char> snapshot = buildSnapshot(roster);
+    storage.checkpointFailed = false;
+    storage.checkpointer = std::thread([&storage, coveredSegment, snapshot = std::move(snapshot)]() {
+        if (writeSnapshotFile(snapshot, storage.snapshotPath)) {
+            syncDirectoryOf(storage.snapshotPath);
+            removeJournalSegments(storage.journalBase, coveredSegment);
+        } else {
+            storage.checkpointFailed = true;
+        }
+    });
+}
+
+/**
+ * @brief Runs a checkpoint and waits for it to finish.
+ * @return true if the snapshot was written.
+ */
+bool checkpointNow(Storage& storage, const Roster& roster) {
+    startCheckpoint(storage, roster);
+    if (storage.checkpointer.joinable()) {
+        storage.checkpointer.join();
+    }
+    return !storage.checkpointFailed;
+}
+
+/**
+ * @brief Writes a final snapshot and removes the journal on exit. If the
+ * snapshot cannot be written the journal is kept for the next start.
+ */
+void closeStorage(Storage& storage, const Roster& roster) {
+    if (storage.checkpointer.joinable()) {
+        storage.checkpointer.join();
+    }
+    storage.journal.close();
+    if (writeSnapshotFile(buildSnapshot(roster), storage.snapshotPath)) {
+        syncDirectoryOf(storage.snapshotPath);
+        removeJournalSegments(storage.journalBase, storage.activeSegment);
+    }
+}
+
+/**
+ * @brief Hashes a student ID for the index (FNV-1a with a final mix).
+ * @param id The ID to hash.
+ * @return A non-zero 64-bit hash; 0 is reserved for empty slots.
+ */
+uint64_t hashStudentId(const std::string& id) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char ch : id) {
+        hash ^= ch;
+        hash *= 1099511628211ull;
+    }
+    // Mix the high bits down, since the slot is taken from the low bits.
+    hash ^= hash >> 32;
+    hash *= 0xD6E8FEB86659FD93ull;
+    hash ^= hash >> 32;
+    return hash == 0 ? 1 : hash;
+}
+
+/**
+ * @brief Grows the index so it can hold studentCount students at no more
+ * than half load, rehashing any existing entries.
+ * @param index The index to grow.
+ * @param studentCount The number of students it must be able to hold.
+ */
+void reserveIndex(StudentIndex& index, size_t studentCount) {
+    size_t capacity = 16;
+    while (capacity < studentCount * 2) {
+        capacity *= 2;
+    }
+    if (capacity <= index.slots.size()) {
+        return;
+    }
+
+    std::vector<IndexSlot> old = std::move(index.slots);
+    index.slots.assign(capacity, {0, -1});
+    size_t mask = capacity - 1;
+    for (const IndexSlot& slot : old) {
+        if (slot.hash == 0) continue;
+        size_t i = slot.hash & mask;
+        while (index.slots[i].hash != 0) {
+            i = (i + 1) & mask;
+        }
+        index.slots[i] = slot;
+    }
+}
+
+/**
+ * @brief Adds the student at a given position to the index.
+ * @param roster A reference to the roster of students.
+ * @param position The position of the student in roster.students.
+ * @return false if another student with the same ID is already indexed;
+ * the earlier student keeps the ID.
+ */
+bool insertIntoIndex(Roster& roster, int position) {
+    StudentIndex& index = roster.index;
+    reserveIndex(index, index.count + 1);
+
+    const std::string& id = roster.students[position].id;
+    uint64_t hash = hashStudentId(id);
+    size_t mask = index.slots.size() - 1;
+    size_t i = hash & mask;
+    while (index.slots[i].hash != 0) {
+        const IndexSlot& slot = index.slots[i];
+        if (slot.hash == hash && roster.students[slot.position].id == id) {
+            return false;
+        }
+        i = (i + 1) & mask;
+    }
+    index.slots[i] = {hash, position};
+    index.count++;
+    return true;
 }
 
 /**
  * @brief Helper function to find a student by their ID.
- * @param students A constant reference to the vector of Student objects.
+ * @param roster A constant reference to the roster of students.
  * @param id The ID to search for.
  * @return The index of the student in the vector, or -1 if not found.
  */
-int findStudentById(const std::vector<Student>& students, const std::string& id) {
-    for (size_t i = 0; i < students.size(); ++i) {
-        if (students[i].id == id) {
-            return i;
+int findStudentById(const Roster& roster, const std::string& id) {
+    const StudentIndex& index = roster.index;
+    if (index.slots.empty()) {
+        return -1;
+    }
+
+    uint64_t hash = hashStudentId(id);
+    size_t mask = index.slots.size() - 1;
+    size_t i = hash & mask;
+    while (index.slots[i].hash != 0) {
+        const IndexSlot& slot = index.slots[i];
+        if (slot.hash == hash && roster.students[slot.position].id == id) {
+            return slot.position;
         }
+        i = (i + 1) & mask;
     }
     return -1;
 }
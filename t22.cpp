@@ -1,6 +1,17 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <random>
+#include <sstream>
 
 using namespace std;
 
@@ -15,32 +26,473 @@ public:
     void displayStatus() {
         cout << "Room " << roomNumber << ": " << (isBooked ? "Occupied" : "Available") << endl;
     }
+
+    // Appends the same line displayStatus prints to a buffer.
+    void appendStatus(string& out) const {
+        out += "Room ";
+        out += to_string(roomNumber);
+        out += isBooked ? ": Occupied\n" : ": Available\n";
+    }
+};
+
+// A bitset of free rooms with summary levels on top. Bit i of level 0 is
+// set when slot i is free; bit j of each higher level is set when word j
+// of the level below has any bit set. Searches skip whole empty words (and
+// whole empty groups of 64 words) using find-first-set on the summaries,
+// so finding the next free room costs a few word operations per level
+// instead of a scan over rooms.
+class OccupancyIndex {
+private:
+    size_t slotCount;
+    size_t freeCount;
+    vector<vector<uint64_t>> levels;  // levels[0] is the room bitset.
+
+    static size_t wordsFor(size_t bits) { return (bits + 63) / 64; }
+
+    // Returns the first set bit at or after pos on a level, or npos.
+    size_t findNextSet(size_t level, size_t pos) const {
+        const vector<uint64_t>& words = levels[level];
+        size_t word = pos / 64;
+        if (word >= words.size()) {
+            return npos;
+        }
+        uint64_t bits = words[word] & (~0ULL << (pos % 64));
+        if (bits != 0) {
+            return word * 64 + __builtin_ctzll(bits);
+        }
+        // Nothing left in this word: find the next non-empty word through
+        // the level above, or by scanning when this is the top level.
+        size_t next;
+        if (level + 1 < levels.size()) {
+            next = findNextSet(level + 1, word + 1);
+            if (next == npos) {
+                return npos;
+            }
+        } else {
+            next = word + 1;
+            while (next < words.size() && words[next] == 0) {
+                ++next;
+            }
+            if (next == words.size()) {
+                return npos;
+            }
+        }
+        return next * 64 + __builtin_ctzll(words[next]);
+    }
+
+public:
+    static const size_t npos = static_cast<size_t>(-1);
+
+    // Creates an index over the given number of slots, all free.
+    explicit OccupancyIndex(size_t slots) : slotCount(slots), freeCount(slots) {
+        size_t bits = slots;
+        do {
+            vector<uint64_t> words(wordsFor(bits), ~0ULL);
+            if (bits % 64 != 0) {
+                words.back() = (1ULL << (bits % 64)) - 1;
+            }
+            levels.push_back(words);
+            bits = words.size();
+        } while (bits > 64);
+    }
+
+    size_t size() const { return slotCount; }
+    size_t countFree() const { return freeCount; }
+
+    bool isFree(size_t slot) const {
+        return (levels[0][slot / 64] >> (slot % 64)) & 1;
+    }
+
+    // Marks a slot free or taken, updating the summaries only where a word
+    // changes between empty and non-empty.
+    void setFree(size_t slot, bool free) {
+        if (isFree(slot) == free) {
+            return;
+        }
+        if (free) {
+            ++freeCount;
+        } else {
+            --freeCount;
+        }
+        size_t pos = slot;
+        for (size_t level = 0; level < levels.size(); ++level) {
+            uint64_t& word = levels[level][pos / 64];
+            bool wasEmpty = word == 0;
+            if (free) {
+                word |= 1ULL << (pos % 64);
+            } else {
+                word &= ~(1ULL << (pos % 64));
+            }
+            if (wasEmpty == (word == 0)) {
+                break;  // The level above is unaffected.
+            }
+            pos /= 64;
+        }
+    }
+
+    // Returns the first free slot at or after start, or npos.
+    size_t findNextFree(size_t start) const {
+        return start < slotCount ? findNextSet(0, start) : npos;
+    }
+
+    // Raw access to the room bitset, 64 slots per word.
+    size_t wordCount() const { return levels[0].size(); }
+    uint64_t word(size_t index) const { return levels[0][index]; }
+
+    // Returns a mask of which of the 64 words in a block (words
+    // block * 64 .. block * 64 + 63) have any free slot.
+    uint64_t blockSummary(size_t block) const {
+        if (levels.size() > 1) {
+            return levels[1][block];
+        }
+        uint64_t mask = 0;
+        for (size_t w = 0; w < levels[0].size(); ++w) {
+            mask |= static_cast<uint64_t>(levels[0][w] != 0) << w;
+        }
+        return mask;
+    }
+
+    // Collects up to count free slots in [start, end), in order.
+    vector<size_t> findFree(size_t count, size_t start, size_t end) const {
+        vector<size_t> found;
+        for (size_t slot = findNextFree(start); slot < end && found.size() < count; slot = findNextFree(slot + 1)) {
+            found.push_back(slot);
+        }
+        return found;
+    }
+
+    // Counts the free slots in [start, end) with one popcount per word.
+    size_t countFree(size_t start, size_t end) const {
+        end = min(end, slotCount);
+        if (start >= end) {
+            return 0;
+        }
+        const vector<uint64_t>& words = levels[0];
+        size_t first = start / 64;
+        size_t last = (end - 1) / 64;
+        uint64_t headMask = ~0ULL << (start % 64);
+        uint64_t tailMask = ~0ULL >> (63 - (end - 1) % 64);
+        if (first == last) {
+            return __builtin_popcountll(words[first] & headMask & tailMask);
+        }
+        size_t total = __builtin_popcountll(words[first] & headMask);
+        for (size_t w = first + 1; w < last; ++w) {
+            total += __builtin_popcountll(words[w]);
+        }
+        return total + __builtin_popcountll(words[last] & tailMask);
+    }
 };
 
+// Days since 1970-01-01 for a proleptic Gregorian date.
+int daysFromCivil(int year, int month, int day) {
+    year -= month <= 2;
+    int era = (year >= 0 ? year : year - 399) / 400;
+    int yearOfEra = year - era * 400;
+    int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+// Formats a day number as YYYY-MM-DD.
+string formatDate(int days) {
+    days += 719468;
+    int era = (days >= 0 ? days : days - 146096) / 146097;
+    int dayOfEra = days - era * 146097;
+    int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int mp = (5 * dayOfYear + 2) / 153;
+    int day = dayOfYear - (153 * mp + 2) / 5 + 1;
+    int month = mp < 10 ? mp + 3 : mp - 9;
+    int year = yearOfEra + era * 400 + (month <= 2);
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%04d-%02d-%02d", year, month, day);
+    return buffer;
+}
+
+// Parses YYYY-MM-DD into a day number. Returns false for malformed or
+// impossible dates.
+bool parseDate(const string& text, int& days) {
+    int year, month, day;
+    char tail;
+    if (sscanf(text.c_str(), "%d-%d-%d%c", &year, &month, &day, &tail) != 3 || month < 1 || month > 12 || day < 1 ||
+        day > 31) {
+        return false;
+    }
+    days = daysFromCivil(year, month, day);
+    char normalized[32];
+    snprintf(normalized, sizeof(normalized), "%04d-%02d-%02d", year, month, day);
+    return formatDate(days) == normalized;  // Rejects dates such as 2025-02-30.
+}
+
+// Parses a count from 1 to max. Returns false for anything but plain
+// digits, and for values out of range.
+bool parseCount(const string& text, unsigned max, unsigned& count) {
+    if (text.empty() || text.size() > 10 || text.find_first_not_of("0123456789") != string::npos) {
+        return false;
+    }
+    unsigned long long value = stoull(text);
+    if (value < 1 || value > max) {
+        return false;
+    }
+    count = static_cast<unsigned>(value);
+    return true;
+}
+
+// One booked stay: the nights checkIn .. checkOut - 1, as day numbers.
+struct Stay {
+    int checkIn;
+    int checkOut;
+};
+
+// A reservation request for one room, as read by the bulk loader.
+struct Reservation {
+    int room;  // 0-based room index.
+    int checkIn;
+    int checkOut;
+};
+
+// Reservations over check-in/check-out date ranges for a fixed horizon of
+// nights. Each room keeps its stays in an array sorted by check-in, so a
+// conflict check is one binary search. Each night also has an occupancy
+// bitset of the rooms still free that night, so "which rooms are free for
+// these nights" is an AND of a few bitsets rather than a scan over every
+// booking.
+class ReservationBook {
+private:
+    int firstNight;
+    int nightCount;
+    vector<vector<Stay>> stays;      // Per room, sorted by checkIn.
+    vector<OccupancyIndex> nights;   // Free rooms per night of the horizon.
+    size_t reservationCount = 0;
+
+    void markNights(size_t room, const Stay& stay, bool free) {
+        for (int night = stay.checkIn; night < stay.checkOut; ++night) {
+            nights[night - firstNight].setFree(room, free);
+        }
+    }
+
+public:
+    enum Result { Reserved, Conflict, OutOfRange, Cancelled, NotFound };
+
+    ReservationBook(size_t rooms, int firstDay, int days)
+        : firstNight(firstDay), nightCount(days), stays(rooms), nights(days, OccupancyIndex(rooms)) {}
+
+    int firstDay() const { return firstNight; }
+    int lastDay() const { return firstNight + nightCount; }  // Latest possible check-out.
+    size_t size() const { return reservationCount; }
+
+    bool inHorizon(int checkIn, int checkOut) const {
+        return checkIn < checkOut && checkIn >= firstNight && checkOut <= firstNight + nightCount;
+    }
+
+    // Books a room for nights checkIn .. checkOut - 1 if none of them are taken.
+    Result reserve(size_t room, int checkIn, int checkOut) {
+        if (room >= stays.size() || !inHorizon(checkIn, checkOut)) {
+            return OutOfRange;
+        }
+        vector<Stay>& roomStays = stays[room];
+        auto next = lower_bound(roomStays.begin(), roomStays.end(), checkIn,
+                                [](const Stay& stay, int day) { return stay.checkIn < day; });
+        if ((next != roomStays.end() && next->checkIn < checkOut) ||
+            (next != roomStays.begin() && prev(next)->checkOut > checkIn)) {
+            return Conflict;
+        }
+        Stay stay{checkIn, checkOut};
+        roomStays.insert(next, stay);
+        markNights(room, stay, false);
+        ++reservationCount;
+        return Reserved;
+    }
+
+    // Cancels the reservation of a room that starts on checkIn.
+    Result cancel(size_t room, int checkIn) {
+        if (room >= stays.size()) {
+            return OutOfRange;
+        }
+        vector<Stay>& roomStays = stays[room];
+        auto found = lower_bound(roomStays.begin(), roomStays.end(), checkIn,
+                                 [](const Stay& stay, int day) { return stay.checkIn < day; });
+        if (found == roomStays.end() || found->checkIn != checkIn) {
+            return NotFound;
+        }
+        markNights(room, *found, true);
+        roomStays.erase(found);
+        --reservationCount;
+        return Cancelled;
+    }
+
+    // Loads many reservations at once. They are sorted by room and check-in
+    // and appended to each room's array in order; requests that fall outside
+    // the horizon or overlap an earlier one are skipped. Returns the number
+    // accepted.
+    size_t bulkLoad(vector<Reservation>& requests) {
+        sort(requests.begin(), requests.end(), [](const Reservation& a, const Reservation& b) {
+            return a.room != b.room ? a.room < b.room : a.checkIn < b.checkIn;
+        });
+        size_t accepted = 0;
+        for (const Reservation& request : requests) {
+            if (request.room < 0 || static_cast<size_t>(request.room) >= stays.size() ||
+                !inHorizon(request.checkIn, request.checkOut)) {
+                continue;
+            }
+            vector<Stay>& roomStays = stays[request.room];
+            if (!roomStays.empty() && roomStays.back().checkOut > request.checkIn) {
+                // Overlaps the stay before it in this batch or one already
+                // booked; fall back to the checked insert.
+                accepted += reserve(request.room, request.checkIn, request.checkOut) == Reserved;
+                continue;
+            }
+            Stay stay{request.checkIn, request.checkOut};
+            roomStays.push_back(stay);
+            markNights(request.room, stay, false);
+            ++reservationCount;
+            ++accepted;
+        }
+        return accepted;
+    }
+
+    // Visits, in order, every word of the room bitset that has a room free
+    // on all nights checkIn .. checkOut - 1, as visit(wordIndex, freeBits),
+    // until visit returns false. The nights' bitsets are ANDed a block of 64
+    // words at a time, and blocks whose summaries show no candidate word are
+    // skipped without touching the bitsets.
+    template <typename Visit>
+    void forEachFreeWord(int checkIn, int checkOut, Visit visit) const {
+        if (!inHorizon(checkIn, checkOut) || stays.empty()) {
+            return;
+        }
+        size_t first = checkIn - firstNight;
+        size_t last = checkOut - firstNight;
+        size_t words = nights[first].wordCount();
+        uint64_t block[64];
+        for (size_t start = 0; start < words; start += 64) {
+            uint64_t candidates = ~0ULL;
+            for (size_t night = first; night < last && candidates; ++night) {
+                candidates &= nights[night].blockSummary(start / 64);
+            }
+            if (candidates == 0) {
+                continue;
+            }
+            size_t count = min<size_t>(64, words - start);
+            for (size_t w = 0; w < count; ++w) {
+                block[w] = nights[first].word(start + w);
+            }
+            for (size_t night = first + 1; night < last; ++night) {
+                const OccupancyIndex& index = nights[night];
+                for (size_t w = 0; w < count; ++w) {
+                    block[w] &= index.word(start + w);
+                }
+            }
+            for (size_t w = 0; w < count; ++w) {
+                if (block[w] && !visit(start + w, block[w])) {
+                    return;
+                }
+            }
+        }
+    }
+
+    // Returns up to limit rooms (0-based) free for every night of the stay.
+    vector<size_t> findFreeRooms(int checkIn, int checkOut, size_t limit) const {
+        vector<size_t> found;
+        if (limit == 0) {
+            return found;
+        }
+        forEachFreeWord(checkIn, checkOut, [&](size_t word, uint64_t bits) {
+            for (; bits && found.size() < limit; bits &= bits - 1) {
+                found.push_back(word * 64 + __builtin_ctzll(bits));
+            }
+            return found.size() < limit;
+        });
+        return found;
+    }
+
+    size_t countFreeRooms(int checkIn, int checkOut) const {
+        size_t count = 0;
+        forEachFreeWord(checkIn, checkOut, [&](size_t, uint64_t bits) {
+            count += __builtin_popcountll(bits);
+            return true;
+        });
+        return count;
+    }
+
+    const vector<Stay>& roomStays(size_t room) const { return stays[room]; }
+};
+
+// How far ahead reservations can be made, in nights.
+const int HORIZON_NIGHTS = 3 * 366;
+
+// Today's date as a day number.
+int currentDay() {
+    return static_cast<int>(time(nullptr) / 86400);
+}
+
 // This class represents the hotel itself, containing a collection of rooms.
+// Rooms are numbered from 1 and grouped into floors of roomsPerFloor rooms
+// (floor 1 holds rooms 1..roomsPerFloor). The occupancy index mirrors
+// isBooked so free-room queries never scan the rooms. Future stays are
+// kept separately in a reservation book starting today.
 class Hotel {
 private:
     vector<Room> rooms;
+    OccupancyIndex freeRooms;
+    int roomsPerFloor;
+    ReservationBook reservations;
+
+    // Parses a check-in/check-out pair, printing why it was rejected.
+    bool parseStay(const string& checkIn, const string& checkOut, int& in, int& out) const {
+        if (!parseDate(checkIn, in) || !parseDate(checkOut, out)) {
+            cout << "Dates must be valid and written as YYYY-MM-DD." << endl;
+            return false;
+        }
+        if (!reservations.inHorizon(in, out)) {
+            cout << "Stays must check out after check-in, between " << formatDate(reservations.firstDay())
+                 << " and " << formatDate(reservations.lastDay()) << "." << endl;
+            return false;
+        }
+        return true;
+    }
+
+    void setBooked(int roomNum, bool booked) {
+        rooms[roomNum - 1].isBooked = booked;
+        freeRooms.setFree(roomNum - 1, !booked);
+    }
+
+    static vector<int> toRoomNumbers(const vector<size_t>& slots) {
+        vector<int> numbers;
+        numbers.reserve(slots.size());
+        for (size_t slot : slots) {
+            numbers.push_back(static_cast<int>(slot) + 1);
+        }
+        return numbers;
+    }
 
 public:
-    Hotel(int numRooms) {
+    Hotel(int numRooms, int floorSize = 10, int firstDay = currentDay())
+        : freeRooms(numRooms), roomsPerFloor(max(1, floorSize)), reservations(numRooms, firstDay, HORIZON_NIGHTS) {
+        rooms.reserve(numRooms);
         for (int i = 1; i <= numRooms; ++i) {
             rooms.push_back(Room(i));
         }
     }
 
+    int floorCount() const {
+        return (static_cast<int>(rooms.size()) + roomsPerFloor - 1) / roomsPerFloor;
+    }
+
     void displayAllRooms() {
-        cout << "--- Room Status ---" << endl;
-        for (Room& room : rooms) {
-            room.displayStatus();
+        string out = "--- Room Status ---\n";
+        out.reserve(rooms.size() * 24 + 64);
+        for (const Room& room : rooms) {
+            room.appendStatus(out);
         }
-        cout << "-------------------" << endl;
+        out += "-------------------\n";
+        cout << out << flush;
     }
 
     void bookRoom(int roomNum) {
-        if (roomNum >= 1 && roomNum <= rooms.size()) {
+        if (roomNum >= 1 && roomNum <= static_cast<int>(rooms.size())) {
             if (!rooms[roomNum - 1].isBooked) {
-                rooms[roomNum - 1].isBooked = true;
+                setBooked(roomNum, true);
                 cout << "Room " << roomNum << " has been booked successfully." << endl;
             } else {
                 cout << "Room " << roomNum << " is already occupied." << endl;
@@ -51,9 +503,9 @@ public:
     }
 
     void checkoutRoom(int roomNum) {
-        if (roomNum >= 1 && roomNum <= rooms.size()) {
+        if (roomNum >= 1 && roomNum <= static_cast<int>(rooms.size())) {
             if (rooms[roomNum - 1].isBooked) {
-                rooms[roomNum - 1].isBooked = false;
+                setBooked(roomNum, false);
                 cout << "Checkout for Room " << roomNum << " successful." << endl;
             } else {
                 cout << "Room " << roomNum << " is not occupied." << endl;
@@ -62,12 +514,485 @@ public:
             cout << "Invalid room number." << endl;
         }
     }
+
+    int countFreeRooms() const {
+        return static_cast<int>(freeRooms.countFree());
+    }
+
+    // Returns up to count free room numbers, starting from room fromRoom.
+    vector<int> findFreeRooms(int count, int fromRoom = 1) const {
+        return toRoomNumbers(freeRooms.findFree(max(count, 0), max(fromRoom, 1) - 1, rooms.size()));
+    }
+
+    int countFreeOnFloor(int floor) const {
+        if (floor < 1 || floor > floorCount()) {
+            return 0;
+        }
+        size_t start = static_cast<size_t>(floor - 1) * roomsPerFloor;
+        return static_cast<int>(freeRooms.countFree(start, start + roomsPerFloor));
+    }
+
+    vector<int> findFreeOnFloor(int floor, int count) const {
+        if (floor < 1 || floor > floorCount()) {
+            return {};
+        }
+        size_t start = static_cast<size_t>(floor - 1) * roomsPerFloor;
+        size_t end = min(start + roomsPerFloor, rooms.size());
+        return toRoomNumbers(freeRooms.findFree(max(count, 0), start, end));
+    }
+
+    void reserveRoom(int roomNum, const string& checkIn, const string& checkOut) {
+        int in, out;
+        if (roomNum < 1 || roomNum > static_cast<int>(rooms.size())) {
+            cout << "Invalid room number." << endl;
+        } else if (parseStay(checkIn, checkOut, in, out)) {
+            if (reservations.reserve(roomNum - 1, in, out) == ReservationBook::Reserved) {
+                cout << "Room " << roomNum << " reserved from " << checkIn << " to " << checkOut << "." << endl;
+            } else {
+                cout << "Room " << roomNum << " is already reserved for some of those nights." << endl;
+            }
+        }
+    }
+
+    void cancelReservation(int roomNum, const string& checkIn) {
+        int in;
+        if (roomNum < 1 || roomNum > static_cast<int>(rooms.size())) {
+            cout << "Invalid room number." << endl;
+        } else if (!parseDate(checkIn, in)) {
+            cout << "Dates must be valid and written as YYYY-MM-DD." << endl;
+        } else if (reservations.cancel(roomNum - 1, in) == ReservationBook::Cancelled) {
+            cout << "Reservation for Room " << roomNum << " from " << checkIn << " cancelled." << endl;
+        } else {
+            cout << "Room " << roomNum << " has no reservation starting " << checkIn << "." << endl;
+        }
+    }
+
+    // Returns up to count room numbers free for every night of a stay.
+    vector<int> findRoomsForStay(const string& checkIn, const string& checkOut, int count) const {
+        int in, out;
+        if (!parseStay(checkIn, checkOut, in, out)) {
+            return {};
+        }
+        cout << reservations.countFreeRooms(in, out) << " rooms are free for the whole stay." << endl;
+        return toRoomNumbers(reservations.findFreeRooms(in, out, max(count, 0)));
+    }
+
+    // Loads reservations from a file with one "room check-in check-out"
+    // line per stay, dates as YYYY-MM-DD.
+    void loadReservations(const string& path) {
+        ifstream file(path);
+        if (!file) {
+            cout << "Could not open " << path << "." << endl;
+            return;
+        }
+        vector<Reservation> requests;
+        string line, checkIn, checkOut;
+        int roomNum, lineNumber = 0;
+        size_t malformed = 0;
+        while (getline(file, line)) {
+            ++lineNumber;
+            istringstream fields(line);
+            Reservation request;
+            if (!(fields >> roomNum >> checkIn >> checkOut) || !parseDate(checkIn, request.checkIn) ||
+                !parseDate(checkOut, request.checkOut)) {
+                if (malformed++ < 5) {
+                    cout << "Skipping malformed line " << lineNumber << "." << endl;
+                }
+                continue;
+            }
+            request.room = roomNum - 1;
+            requests.push_back(request);
+        }
+        size_t accepted = reservations.bulkLoad(requests);
+        cout << "Loaded " << accepted << " reservations; " << requests.size() - accepted
+             << " conflicted or fell outside the horizon, " << malformed << " lines were malformed." << endl;
+    }
 };
 
-int main() {
-    // Create a hotel with 10 rooms.
-    Hotel myHotel(10);
-    int choice, roomNumber;
+// A booking core that many threads can use at once without a lock. Each
+// room's state is one atomic word, changed only by compare-and-swap:
+//
+//   bit 0        set while the room is booked
+//   bits 1-31    the guest holding the room
+//   bits 32-63   a version, bumped on every change so a stale word never
+//                compares equal (no ABA)
+//
+// A bitset of free rooms, also atomic, lets "book any N" find candidates
+// 64 rooms at a time. The room words are the truth and the bitset is only
+// a hint. Whoever changes a room refreshes its hint bit afterwards and
+// re-reads the room; if the room changed meanwhile it writes the bit again.
+// The last thread to write a bit has therefore seen the room's final
+// state, so once the threads touching a room are done its bit is exact:
+// free rooms are never hidden and booked rooms never look free.
+class BookingEngine {
+private:
+    vector<atomic<uint64_t>> states;
+    vector<atomic<uint64_t>> freeHint;
+
+    static const uint64_t BOOKED = 1;
+    static const uint64_t GUEST_MASK = 0xFFFFFFFEULL;
+    static const uint64_t VERSION_STEP = 1ULL << 32;
+
+    void refreshHint(size_t room) {
+        uint64_t bit = 1ULL << (room % 64);
+        bool free = !(states[room].load() & BOOKED);
+        while (true) {
+            if (free) {
+                freeHint[room / 64].fetch_or(bit);
+            } else {
+                freeHint[room / 64].fetch_and(~bit);
+            }
+            bool stillFree = !(states[room].load() & BOOKED);
+            if (stillFree == free) {
+                return;
+            }
+            free = stillFree;
+        }
+    }
+
+public:
+    explicit BookingEngine(size_t rooms) : states(rooms), freeHint((rooms + 63) / 64) {
+        for (auto& state : states) {
+            state.store(0, memory_order_relaxed);
+        }
+        for (size_t w = 0; w < freeHint.size(); ++w) {
+            size_t bits = min<size_t>(64, rooms - w * 64);
+            freeHint[w].store(bits == 64 ? ~0ULL : (1ULL << bits) - 1, memory_order_relaxed);
+        }
+    }
+
+    size_t size() const { return states.size(); }
+
+    // Books a room for a guest (1 .. 2^31 - 1). Fails if it is booked.
+    bool book(size_t room, uint32_t guest) {
+        uint64_t state = states[room].load();
+        while (!(state & BOOKED)) {
+            uint64_t next = ((state & ~GUEST_MASK & ~BOOKED) + VERSION_STEP) | (static_cast<uint64_t>(guest) << 1) | BOOKED;
+            if (states[room].compare_exchange_weak(state, next)) {
+                refreshHint(room);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Checks a guest out of a room. Fails unless that guest holds it.
+    bool checkout(size_t room, uint32_t guest) {
+        uint64_t state = states[room].load();
+        while ((state & BOOKED) && ((state & GUEST_MASK) >> 1) == guest) {
+            uint64_t next = (state & ~GUEST_MASK & ~BOOKED) + VERSION_STEP;
+            if (states[room].compare_exchange_weak(state, next)) {
+                refreshHint(room);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Books up to count free rooms for a guest, searching the hint bitset
+    // from word startWord and wrapping around. Callers spread startWord to
+    // keep concurrent searches apart. Booked rooms are appended to booked;
+    // returns how many were booked.
+    size_t bookAny(size_t count, uint32_t guest, size_t startWord, vector<size_t>& booked) {
+        size_t words = freeHint.size();
+        size_t done = 0;
+        for (size_t i = 0; i < words && done < count; ++i) {
+            size_t w = (startWord + i) % words;
+            uint64_t bits = freeHint[w].load(memory_order_relaxed);
+            for (; bits && done < count; bits &= bits - 1) {
+                size_t room = w * 64 + __builtin_ctzll(bits);
+                if (book(room, guest)) {
+                    booked.push_back(room);
+                    ++done;
+                }
+            }
+        }
+        return done;
+    }
+
+    // The guest holding a room, or 0 if it is free.
+    uint32_t holder(size_t room) const {
+        uint64_t state = states[room].load();
+        return (state & BOOKED) ? static_cast<uint32_t>((state & GUEST_MASK) >> 1) : 0;
+    }
+
+    // Whether the hint marks a room free; only meaningful when quiescent.
+    bool hintedFree(size_t room) const {
+        return (freeHint[room / 64].load() >> (room % 64)) & 1;
+    }
+};
+
+// The outcome of one load-generator run.
+struct BookingLoadResult {
+    double seconds = 0;
+    size_t bookings = 0;                       // Rooms successfully booked.
+    vector<uint32_t> latencies;                // Per operation, in nanoseconds.
+    vector<vector<size_t>> held;               // Rooms each client holds at the end.
+};
+
+// Runs many simulated booking clients on a number of threads against one
+// BookingEngine. Each thread drives its share of the clients in turn; a
+// client books a specific room, books any 1-4 rooms, or checks out of a
+// room it holds. Every operation is timed.
+BookingLoadResult runBookingLoad(BookingEngine& engine, unsigned threads, size_t clients, size_t opsPerThread) {
+    using Clock = chrono::steady_clock;
+    vector<vector<uint32_t>> latencies(threads);
+    vector<size_t> bookings(threads, 0);
+    BookingLoadResult result;
+    result.held.assign(clients, {});
+    atomic<unsigned> ready{0};
+    atomic<bool> go{false};
+
+    auto worker = [&](unsigned t) {
+        size_t firstClient = clients * t / threads;
+        size_t clientCount = clients * (t + 1) / threads - firstClient;
+        vector<uint32_t>& samples = latencies[t];
+        samples.reserve(opsPerThread);
+        mt19937_64 rng(1000 + t);
+        size_t words = (engine.size() + 63) / 64;
+
+        ready++;
+        while (!go.load()) {
+        }
+        for (size_t op = 0; op < opsPerThread && clientCount > 0; ++op) {
+            size_t client = firstClient + op % clientCount;
+            uint32_t guest = static_cast<uint32_t>(client + 1);
+            vector<size_t>& mine = result.held[client];
+            uint64_t r = rng();
+            auto start = Clock::now();
+            if (!mine.empty() && r % 100 < 45) {
+                size_t pick = (r >> 8) % mine.size();
+                engine.checkout(mine[pick], guest);
+                mine[pick] = mine.back();
+                mine.pop_back();
+            } else if (r % 100 < 70) {
+                size_t room = (r >> 8) % engine.size();
+                if (engine.book(room, guest)) {
+                    mine.push_back(room);
+                    ++bookings[t];
+                }
+            } else {
+                bookings[t] += engine.bookAny(1 + (r >> 8) % 4, guest, (r >> 16) % words, mine);
+            }
+            auto nanos = chrono::duration_cast<chrono::nanoseconds>(Clock::now() - start).count();
+            samples.push_back(static_cast<uint32_t>(min<int64_t>(nanos, UINT32_MAX)));
+        }
+    };
+
+    vector<thread> pool;
+    for (unsigned t = 0; t < threads; ++t) {
+        pool.emplace_back(worker, t);
+    }
+    while (ready.load() < threads) {
+        this_thread::yield();
+    }
+    auto start = Clock::now();
+    go = true;
+    for (auto& th : pool) {
+        th.join();
+    }
+    result.seconds = chrono::duration<double>(Clock::now() - start).count();
+
+    for (unsigned t = 0; t < threads; ++t) {
+        result.latencies.insert(result.latencies.end(), latencies[t].begin(), latencies[t].end());
+        result.bookings += bookings[t];
+    }
+    return result;
+}
+
+// Drives the lock-free booking core with thousands of simulated clients at
+// increasing thread counts and reports operations per second, bookings per
+// second and latency percentiles. After each run it checks that every room
+// is held by exactly the client that thinks it holds it, and that every
+// other room is free and visible to searches.
+void runBookingStress(size_t rooms, size_t clients, size_t opsPerThread, unsigned maxThreads) {
+    vector<unsigned> threadCounts;
+    for (unsigned threads = 1; threads < maxThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+        if (threads > maxThreads / 2) {
+            break;  // Doubling again would pass maxThreads.
+        }
+    }
+    threadCounts.push_back(maxThreads);
+
+    cout << "Rooms: " << rooms << ", clients: " << clients << ", operations per thread: " << opsPerThread << "\n"
+         << "threads  ops/s        bookings/s   p50 ns    p99 ns    p999 ns   consistent" << endl;
+    for (unsigned threads : threadCounts) {
+        BookingEngine engine(rooms);
+        BookingLoadResult result = runBookingLoad(engine, threads, clients, opsPerThread);
+
+        vector<uint32_t> owner(rooms, 0);
+        bool consistent = true;
+        for (size_t client = 0; client < clients; ++client) {
+            for (size_t room : result.held[client]) {
+                consistent &= owner[room] == 0;
+                owner[room] = static_cast<uint32_t>(client + 1);
+            }
+        }
+        for (size_t room = 0; room < rooms; ++room) {
+            consistent &= engine.holder(room) == owner[room] && engine.hintedFree(room) == (owner[room] == 0);
+        }
+
+        vector<uint32_t>& all = result.latencies;
+        auto percentile = [&](double p) {
+            if (all.empty()) {
+                return 0u;
+            }
+            size_t k = min(all.size() - 1, static_cast<size_t>(p * all.size()));
+            nth_element(all.begin(), all.begin() + k, all.end());
+            return all[k];
+        };
+        uint32_t p50 = percentile(0.50);
+        uint32_t p99 = percentile(0.99);
+        uint32_t p999 = percentile(0.999);
+        printf("%-8u %-12.0f %-12.0f %-9u %-9u %-9u %s\n", threads, all.size() / result.seconds,
+               result.bookings / result.seconds, p50, p99, p999, consistent ? "yes" : "NO");
+    }
+}
+
+// Generates reservations that do not conflict: each room's timeline is
+// filled with stays of 1-7 nights separated by gaps of 0-3 nights, taking
+// rooms in turn until the target count is reached or every room is full.
+vector<Reservation> generateReservations(size_t rooms, int firstDay, int nights, size_t target, mt19937_64& rng) {
+    vector<Reservation> requests;
+    requests.reserve(target);
+    vector<int> cursor(rooms);
+    for (size_t room = 0; room < rooms; ++room) {
+        cursor[room] = firstDay + static_cast<int>(rng() % 5);
+    }
+    size_t open = rooms;
+    while (requests.size() < target && open > 0) {
+        open = 0;
+        for (size_t room = 0; room < rooms && requests.size() < target; ++room) {
+            int checkIn = cursor[room] + static_cast<int>(rng() % 4);
+            int checkOut = checkIn + 1 + static_cast<int>(rng() % 7);
+            if (checkOut > firstDay + nights) {
+                continue;
+            }
+            requests.push_back({static_cast<int>(room), checkIn, checkOut});
+            cursor[room] = checkOut;
+            ++open;
+        }
+    }
+    return requests;
+}
+
+// Bulk loads millions of generated reservations over a multi-year horizon,
+// then times availability queries and single reserve/cancel operations.
+void runReservationBenchmark(size_t rooms, size_t target, int years) {
+    using Clock = chrono::steady_clock;
+    auto elapsed = [](Clock::time_point start) { return chrono::duration<double>(Clock::now() - start).count(); };
+    mt19937_64 rng(2024);
+    int firstDay = daysFromCivil(2025, 1, 1);
+    int nights = years * 366;
+
+    vector<Reservation> requests = generateReservations(rooms, firstDay, nights, target, rng);
+    shuffle(requests.begin(), requests.end(), rng);
+    size_t generated = requests.size();
+
+    ReservationBook book(rooms, firstDay, nights);
+    auto start = Clock::now();
+    size_t accepted = book.bulkLoad(requests);
+    double loadSeconds = elapsed(start);
+
+    const int queries = 100000;
+    vector<pair<int, int>> stays(queries);
+    for (auto& stay : stays) {
+        stay.first = firstDay + static_cast<int>(rng() % (nights - 14));
+        stay.second = stay.first + 1 + static_cast<int>(rng() % 14);
+    }
+    size_t checksum = 0;
+    start = Clock::now();
+    for (const auto& stay : stays) {
+        checksum += book.countFreeRooms(stay.first, stay.second);
+    }
+    double countSeconds = elapsed(start);
+    start = Clock::now();
+    for (const auto& stay : stays) {
+        checksum += book.findFreeRooms(stay.first, stay.second, 10).size();
+    }
+    double findSeconds = elapsed(start);
+
+    size_t reserved = 0;
+    start = Clock::now();
+    for (const auto& stay : stays) {
+        size_t room = rng() % rooms;
+        if (book.reserve(room, stay.first, stay.second) == ReservationBook::Reserved) {
+            ++reserved;
+            book.cancel(room, stay.first);
+        }
+    }
+    double updateSeconds = elapsed(start);
+
+    cout << "Rooms: " << rooms << ", horizon: " << nights << " nights from " << formatDate(firstDay) << "\n"
+         << "Bulk load: " << accepted << " of " << generated << " reservations in " << loadSeconds << " s ("
+         << accepted / loadSeconds / 1e6 << " M/s)\n"
+         << "Count free for a stay: " << countSeconds / queries * 1e6 << " us/query\n"
+         << "Find 10 free for a stay: " << findSeconds / queries * 1e6 << " us/query\n"
+         << "Reserve + cancel: " << updateSeconds / queries * 1e6 << " us/op (" << reserved << " of " << queries
+         << " reserved)\n"
+         << "Checksum: " << checksum << endl;
+}
+
+// Prints a list of room numbers on one line.
+void printRoomList(const vector<int>& roomNumbers) {
+    if (roomNumbers.empty()) {
+        cout << "No free rooms found." << endl;
+        return;
+    }
+    string out = "Free rooms:";
+    for (int number : roomNumbers) {
+        out += ' ';
+        out += to_string(number);
+    }
+    cout << out << endl;
+}
+
+int main(int argc, char* argv[]) {
+    // t22 --bench [rooms] [reservations] [years] runs the reservation benchmark.
+    if (argc > 1 && string(argv[1]) == "--bench") {
+        long benchRooms = argc > 2 ? atol(argv[2]) : 50000;
+        long benchReservations = argc > 3 ? atol(argv[3]) : 5000000;
+        int years = argc > 4 ? atoi(argv[4]) : 3;
+        if (benchRooms < 1 || benchReservations < 0 || years < 1) {
+            cerr << "Error: usage: t22 --bench [rooms] [reservations] [years]" << endl;
+            return 1;
+        }
+        runReservationBenchmark(benchRooms, benchReservations, years);
+        return 0;
+    }
+
+    // t22 --stress [threads] [rooms] [clients] [operations per thread] runs
+    // the concurrent booking load generator.
+    if (argc > 1 && string(argv[1]) == "--stress") {
+        const unsigned MAX_STRESS_THREADS = 1024;
+        unsigned threads = min(MAX_STRESS_THREADS, max(1u, thread::hardware_concurrency()));
+        if (argc > 2 && !parseCount(argv[2], MAX_STRESS_THREADS, threads)) {
+            cerr << "Error: The thread count must be between 1 and " << MAX_STRESS_THREADS << "." << endl;
+            return 1;
+        }
+        long stressRooms = argc > 3 ? atol(argv[3]) : 100000;
+        long clients = argc > 4 ? atol(argv[4]) : 4096;
+        long ops = argc > 5 ? atol(argv[5]) : 1000000;
+        if (stressRooms < 1 || clients < 1 || clients > 0x7FFFFFFF || ops < 1) {
+            cerr << "Error: usage: t22 --stress [threads] [rooms] [clients] [operations per thread]" << endl;
+            return 1;
+        }
+        runBookingStress(stressRooms, clients, ops, threads);
+        return 0;
+    }
+
+    // Create a hotel with 10 rooms, or the size given on the command line:
+    // t22 [rooms] [rooms per floor]
+    int numRooms = argc > 1 ? atoi(argv[1]) : 10;
+    int roomsPerFloor = argc > 2 ? atoi(argv[2]) : 10;
+    if (numRooms < 1) {
+        cerr << "Error: The number of rooms must be positive." << endl;
+        return 1;
+    }
+    Hotel myHotel(numRooms, roomsPerFloor);
+    int choice, roomNumber, count, floor;
+    string checkIn, checkOut, path;
 
     while (true) {
         cout << "\n--- Hotel Management System ---" << endl;
@@ -75,6 +1000,13 @@ int main() {
         cout << "2. Book a room" << endl;
         cout << "3. Checkout a room" << endl;
         cout << "4. Exit" << endl;
+        cout << "5. Find free rooms" << endl;
+        cout << "6. Count free rooms" << endl;
+        cout << "7. Free rooms on a floor" << endl;
+        cout << "8. Reserve a room for dates" << endl;
+        cout << "9. Cancel a reservation" << endl;
+        cout << "10. Find rooms free for dates" << endl;
+        cout << "11. Load reservations from a file" << endl;
         cout << "Enter your choice: ";
         cin >> choice;
 
@@ -95,9 +1027,61 @@ int main() {
             case 4:
                 cout << "Exiting program. Goodbye!" << endl;
                 return 0;
+            case 5:
+                cout << "How many rooms: ";
+                cin >> count;
+                cout << "Starting from room: ";
+                cin >> roomNumber;
+                printRoomList(myHotel.findFreeRooms(count, roomNumber));
+                break;
+            case 6:
+                cout << myHotel.countFreeRooms() << " of " << numRooms << " rooms are free." << endl;
+                break;
+            case 7:
+                cout << "Enter floor (1-" << myHotel.floorCount() << "): ";
+                cin >> floor;
+                cout << "How many rooms: ";
+                cin >> count;
+                cout << myHotel.countFreeOnFloor(floor) << " rooms free on floor " << floor << "." << endl;
+                printRoomList(myHotel.findFreeOnFloor(floor, count));
+                break;
+            case 8:
+                cout << "Enter room number: ";
+                cin >> roomNumber;
+                cout << "Check-in date (YYYY-MM-DD): ";
+                cin >> checkIn;
+                cout << "Check-out date (YYYY-MM-DD): ";
+                cin >> checkOut;
+                myHotel.reserveRoom(roomNumber, checkIn, checkOut);
+                break;
+            case 9:
+                cout << "Enter room number: ";
+                cin >> roomNumber;
+                cout << "Check-in date of the reservation (YYYY-MM-DD): ";
+                cin >> checkIn;
+                myHotel.cancelReservation(roomNumber, checkIn);
+                break;
+            case 10:
+                cout << "Check-in date (YYYY-MM-DD): ";
+                cin >> checkIn;
+                cout << "Check-out date (YYYY-MM-DD): ";
+                cin >> checkOut;
+                cout << "How many rooms: ";
+                cin >> count;
+                printRoomList(myHotel.findRoomsForStay(checkIn, checkOut, count));
+                break;
+            case 11:
+                cout << "Reservation file (room check-in check-out per line): ";
+                cin >> path;
+                myHotel.loadReservations(path);
+                break;
             default:
                 cout << "Invalid choice. Please try again." << endl;
         }
+        if (!cin) {
+            cout << "Input closed. Goodbye!" << endl;
+            return 0;
+        }
     }
     return 0;
 }
\ No newline at end of file
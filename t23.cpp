@@ -4,73 +4,1016 @@
 #include <ctime>
 #include <cstdlib>
 #include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <random>
+#include <thread>
 
-void display_game_status(const std::string& secret_word, const std::string& guessed_letters) {
-    std::cout << "\nWord to guess: ";
-    for (char letter : secret_word) {
-        if (guessed_letters.find(letter) != std::string::npos) {
-            std::cout << letter << " ";
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Words longer than this are skipped; position masks are 32 bits wide.
+const int MAX_WORD_LENGTH = 32;
+
+// Candidate sets at or below this size are scored by the exact entropy of
+// the reveal patterns; larger sets by the entropy of the present/absent
+// split, which needs only the letter masks.
+const size_t EXACT_ENTROPY_LIMIT = 512;
+
+// Letters in rough English frequency order, used when there is nothing
+// better to go on.
+const char FALLBACK_ORDER[] = "etaoinshrdlucmfwypvbgkqjxz";
+
+/**
+ * All dictionary words of one length, stored column-wise so filters run
+ * over contiguous arrays:
+ *   letter_masks[i]                bit c set if letter 'a' + c occurs in word i
+ *   positions[c * count + i]       bit p set if word i has letter 'a' + c at position p
+ * Words themselves stay in the dictionary text and are found by offset.
+ */
+struct LengthBucket {
+    size_t count = 0;
+    std::vector<uint64_t> offsets;
+    std::vector<uint32_t> letter_masks;
+    std::vector<uint32_t> positions;
+    uint32_t letter_counts[26] = {};  // Words containing each letter.
+
+    const uint32_t* positions_of(int letter) const { return positions.data() + static_cast<size_t>(letter) * count; }
+};
+
+/**
+ * A word list indexed by length. The text is either a read-only mapping of
+ * the word file or, for built-in lists, an owned string; words are one per
+ * line and only those made of ASCII letters are indexed (folded to lower
+ * case, each folded word once).
+ */
+struct Dictionary {
+    const char* text = nullptr;
+    size_t size = 0;
+    std::string owned_text;
+    void* mapping = nullptr;
+    std::vector<LengthBucket> buckets = std::vector<LengthBucket>(MAX_WORD_LENGTH + 1);
+    size_t word_count = 0;
+};
+
+/**
+ * What the player knows about the secret word: which letters were guessed,
+ * which of those are absent, and where each present one was revealed.
+ */
+struct GuessState {
+    uint32_t guessed = 0;
+    uint32_t absent = 0;
+    uint32_t revealed[26] = {};
+};
+
+/**
+ * Calls visit(start, length) for every line of text that is a usable word.
+ */
+template <typename Visit>
+void for_each_word(const char* text, size_t size, Visit visit) {
+    const char* end = text + size;
+    const char* line = text;
+    while (line < end) {
+        const char* newline = static_cast<const char*>(std::memchr(line, '\n', end - line));
+        const char* line_end = newline ? newline : end;
+        const char* word_end = line_end;
+        if (word_end > line && word_end[-1] == '\r') {
+            --word_end;
+        }
+        size_t length = word_end - line;
+        if (length > 0 && length <= static_cast<size_t>(MAX_WORD_LENGTH) &&
+            std::all_of(line, word_end, [](char c) { return std::isalpha(static_cast<unsigned char>(c)); })) {
+            visit(line, length);
+        }
+        line = line_end + 1;
+    }
+}
+
+/**
+ * Open-addressing set of words in a text, compared without case. Words
+ * are stored as offsets into the text, so inserting copies nothing.
+ */
+struct FoldedWordSet {
+    struct Slot {
+        uint64_t offset = 0;
+        uint32_t length = 0;  // 0 marks an empty slot.
+        uint32_t hash = 0;
+    };
+
+    const char* text;
+    std::vector<Slot> slots = std::vector<Slot>(1024);
+    size_t count = 0;
+
+    explicit FoldedWordSet(const char* text) : text(text) {}
+
+    // Words are ASCII letters only, so setting bit 5 folds case exactly.
+    static uint32_t hash_of(const char* word, size_t length) {
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < length; ++i) {
+            hash ^= static_cast<unsigned char>(word[i] | 0x20);
+            hash *= 1099511628211ull;
+        }
+        return static_cast<uint32_t>(hash ^ (hash >> 32));
+    }
+
+    static bool equal_folded(const char* a, const char* b, size_t length) {
+        for (size_t i = 0; i < length; ++i) {
+            if ((a[i] | 0x20) != (b[i] | 0x20)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static void place(std::vector<Slot>& slots, const Slot& slot) {
+        size_t mask = slots.size() - 1;
+        size_t i = slot.hash & mask;
+        while (slots[i].length != 0) {
+            i = (i + 1) & mask;
+        }
+        slots[i] = slot;
+    }
+
+    /**
+     * Adds a word of the text.
+     * @return false if an equal word, ignoring case, was already there.
+     */
+    bool insert(const char* word, size_t length) {
+        if (2 * (count + 1) > slots.size()) {
+            std::vector<Slot> grown(slots.size() * 2);
+            for (const Slot& slot : slots) {
+                if (slot.length != 0) {
+                    place(grown, slot);
+                }
+            }
+            slots.swap(grown);
+        }
+        uint32_t hash = hash_of(word, length);
+        size_t mask = slots.size() - 1;
+        for (size_t i = hash & mask; slots[i].length != 0; i = (i + 1) & mask) {
+            const Slot& slot = slots[i];
+            if (slot.hash == hash && slot.length == length && equal_folded(text + slot.offset, word, length)) {
+                return false;
+            }
+        }
+        place(slots, {static_cast<uint64_t>(word - text), static_cast<uint32_t>(length), hash});
+        ++count;
+        return true;
+    }
+};
+
+/**
+ * Builds the per-length buckets from the dictionary text in two passes:
+ * one to size every bucket and drop repeats, one to fill the masks.
+ */
+void index_words(Dictionary& dictionary) {
+    // A word that repeats after case folding ("Apple", "apple") is indexed
+    // once, so it is one candidate and counts once in letter_counts.
+    std::vector<size_t> sizes(MAX_WORD_LENGTH + 1, 0);
+    std::vector<bool> first_seen;
+    {
+        FoldedWordSet seen(dictionary.text);
+        for_each_word(dictionary.text, dictionary.size, [&](const char* word, size_t length) {
+            bool is_new = seen.insert(word, length);
+            first_seen.push_back(is_new);
+            sizes[length] += is_new;
+        });
+    }
+
+    for (int length = 1; length <= MAX_WORD_LENGTH; ++length) {
+        LengthBucket& bucket = dictionary.buckets[length];
+        bucket.count = 0;
+        bucket.offsets.resize(sizes[length]);
+        bucket.letter_masks.resize(sizes[length]);
+        bucket.positions.assign(sizes[length] * 26, 0);
+        std::fill(std::begin(bucket.letter_counts), std::end(bucket.letter_counts), 0);
+    }
+
+    // Fill in the masks; bucket.count doubles as the insertion cursor and
+    // positions are addressed with the final count.
+    size_t word_index = 0;
+    for_each_word(dictionary.text, dictionary.size, [&](const char* word, size_t length) {
+        if (!first_seen[word_index++]) {
+            return;
+        }
+        LengthBucket& bucket = dictionary.buckets[length];
+        size_t i = bucket.count++;
+        uint32_t mask = 0;
+        for (size_t p = 0; p < length; ++p) {
+            int letter = std::tolower(static_cast<unsigned char>(word[p])) - 'a';
+            mask |= 1u << letter;
+            bucket.positions[letter * sizes[length] + i] |= 1u << p;
+        }
+        bucket.offsets[i] = static_cast<uint64_t>(word - dictionary.text);
+        bucket.letter_masks[i] = mask;
+        for (uint32_t bits = mask; bits; bits &= bits - 1) {
+            ++bucket.letter_counts[__builtin_ctz(bits)];
+        }
+    });
+
+    dictionary.word_count = 0;
+    for (const LengthBucket& bucket : dictionary.buckets) {
+        dictionary.word_count += bucket.count;
+    }
+}
+
+/**
+ * Releases the mapping of a dictionary loaded from a file.
+ */
+void close_dictionary(Dictionary& dictionary) {
+    if (dictionary.mapping) {
+        munmap(dictionary.mapping, dictionary.size);
+        dictionary.mapping = nullptr;
+        dictionary.text = nullptr;
+        dictionary.size = 0;
+    }
+}
+
+/**
+ * Maps a word file (one word per line) and indexes it.
+ * @return false if the file cannot be read or holds no usable words.
+ */
+bool load_dictionary(Dictionary& dictionary, const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Error: Could not open " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        std::cerr << "Error: " << path << " is empty or unreadable." << std::endl;
+        close(fd);
+        return false;
+    }
+    void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Error: Could not map " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    madvise(mapping, info.st_size, MADV_SEQUENTIAL);
+
+    dictionary.mapping = mapping;
+    dictionary.text = static_cast<const char*>(mapping);
+    dictionary.size = static_cast<size_t>(info.st_size);
+    index_words(dictionary);
+    if (dictionary.word_count == 0) {
+        std::cerr << "Error: " << path << " contains no usable words." << std::endl;
+        close_dictionary(dictionary);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Indexes an in-memory word list.
+ */
+void build_dictionary(Dictionary& dictionary, const std::vector<std::string>& words) {
+    dictionary.owned_text.clear();
+    for (const std::string& word : words) {
+        dictionary.owned_text += word;
+        dictionary.owned_text += '\n';
+    }
+    dictionary.text = dictionary.owned_text.data();
+    dictionary.size = dictionary.owned_text.size();
+    index_words(dictionary);
+}
+
+/**
+ * Returns word i of a bucket, in lower case.
+ */
+std::string word_at(const Dictionary& dictionary, int length, size_t i) {
+    std::string word(dictionary.text + dictionary.buckets[length].offsets[i], length);
+    for (char& c : word) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return word;
+}
+
+/**
+ * Records a guess and what it revealed about a secret word.
+ */
+void apply_guess(GuessState& state, const std::string& secret_word, char guess) {
+    int letter = guess - 'a';
+    uint32_t revealed = 0;
+    for (size_t p = 0; p < secret_word.size(); ++p) {
+        if (secret_word[p] == guess) {
+            revealed |= 1u << p;
+        }
+    }
+    state.guessed |= 1u << letter;
+    state.revealed[letter] = revealed;
+    if (revealed == 0) {
+        state.absent |= 1u << letter;
+    }
+}
+
+/**
+ * Finds every word of a bucket consistent with a guess state: it contains
+ * none of the absent letters, and each present guessed letter sits exactly
+ * at its revealed positions. With SSE2 four words are tested per step
+ * with vector compares over the letter and position columns.
+ * @param bucket The words of the secret word's length.
+ * @param state What has been guessed and revealed.
+ * @param candidates Receives the indices of consistent words.
+ */
+void filter_candidates(const LengthBucket& bucket, const GuessState& state, std::vector<uint32_t>& candidates) {
+    candidates.clear();
+    int present[26];
+    int present_count = 0;
+    for (uint32_t bits = state.guessed & ~state.absent; bits; bits &= bits - 1) {
+        present[present_count++] = __builtin_ctz(bits);
+    }
+
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i absent = _mm_set1_epi32(static_cast<int>(state.absent));
+    for (; i + 4 <= bucket.count; i += 4) {
+        __m128i masks = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bucket.letter_masks.data() + i));
+        __m128i ok = _mm_cmpeq_epi32(_mm_and_si128(masks, absent), zero);
+        for (int k = 0; k < present_count; ++k) {
+            __m128i positions = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bucket.positions_of(present[k]) + i));
+            ok = _mm_and_si128(ok, _mm_cmpeq_epi32(positions, _mm_set1_epi32(static_cast<int>(state.revealed[present[k]]))));
+        }
+        for (int hits = _mm_movemask_ps(_mm_castsi128_ps(ok)); hits; hits &= hits - 1) {
+            candidates.push_back(static_cast<uint32_t>(i + __builtin_ctz(hits)));
+        }
+    }
+#endif
+    for (; i < bucket.count; ++i) {
+        bool ok = (bucket.letter_masks[i] & state.absent) == 0;
+        for (int k = 0; k < present_count && ok; ++k) {
+            ok = bucket.positions_of(present[k])[i] == state.revealed[present[k]];
+        }
+        if (ok) {
+            candidates.push_back(static_cast<uint32_t>(i));
+        }
+    }
+}
+
+/**
+ * Narrows a candidate list after one more guess, keeping the words whose
+ * positions of that letter match what was revealed.
+ */
+void refine_candidates(const LengthBucket& bucket, const GuessState& state, char guess,
+                       std::vector<uint32_t>& candidates) {
+    int letter = guess - 'a';
+    const uint32_t* positions = bucket.positions_of(letter);
+    uint32_t revealed = state.revealed[letter];
+    size_t kept = 0;
+    for (uint32_t index : candidates) {
+        if (positions[index] == revealed) {
+            candidates[kept++] = index;
+        }
+    }
+    candidates.resize(kept);
+}
+
+/**
+ * Entropy in bits of splitting total items into a group of part and the rest.
+ */
+double split_entropy(size_t part, size_t total) {
+    if (part == 0 || part == total) {
+        return 0.0;
+    }
+    double p = static_cast<double>(part) / total;
+    return -(p * std::log2(p) + (1 - p) * std::log2(1 - p));
+}
+
+/**
+ * Picks the unguessed letter that tells the most about the secret word.
+ * For small candidate sets every letter is scored by the exact entropy of
+ * the reveal patterns it would produce (which positions light up, or
+ * none); for large ones by the entropy of the split between candidates
+ * that contain it and those that do not, counted from the letter masks or,
+ * before any guess, read from the bucket's precomputed counts. Ties go to
+ * the letter more candidates contain, which risks fewer misses.
+ * @param bucket The words of the secret word's length.
+ * @param state What has been guessed and revealed.
+ * @param candidates The words still consistent with state.
+ * Once one candidate is left, any of its unguessed letters is returned.
+ * @return The letter to guess, or 0 if every letter has been guessed.
+ */
+char best_guess(const LengthBucket& bucket, const GuessState& state, const std::vector<uint32_t>& candidates) {
+    size_t total = candidates.size();
+    if (total == 1) {
+        // The word is known: any letter of it not yet guessed.
+        uint32_t missing = bucket.letter_masks[candidates[0]] & ~state.guessed;
+        if (missing) {
+            return static_cast<char>('a' + __builtin_ctz(missing));
+        }
+    }
+    size_t counts[26] = {};
+    if (state.guessed == 0 && total == bucket.count) {
+        std::copy(std::begin(bucket.letter_counts), std::end(bucket.letter_counts), counts);
+    } else {
+        for (uint32_t index : candidates) {
+            for (uint32_t bits = bucket.letter_masks[index] & ~state.guessed; bits; bits &= bits - 1) {
+                ++counts[__builtin_ctz(bits)];
+            }
+        }
+    }
+
+    std::vector<uint32_t> patterns;
+    char best = 0;
+    double best_score = -1.0;
+    size_t best_count = 0;
+    for (const char* c = FALLBACK_ORDER; *c; ++c) {
+        int letter = *c - 'a';
+        if (state.guessed & (1u << letter)) {
+            continue;
+        }
+        double score;
+        if (total <= EXACT_ENTROPY_LIMIT && counts[letter] > 0) {
+            const uint32_t* positions = bucket.positions_of(letter);
+            patterns.clear();
+            for (uint32_t index : candidates) {
+                patterns.push_back(positions[index]);
+            }
+            std::sort(patterns.begin(), patterns.end());
+            score = 0.0;
+            for (size_t run = 0; run < patterns.size();) {
+                size_t next = run;
+                while (next < patterns.size() && patterns[next] == patterns[run]) {
+                    ++next;
+                }
+                double p = static_cast<double>(next - run) / total;
+                score -= p * std::log2(p);
+                run = next;
+            }
         } else {
-            std::cout << "_ ";
+            score = split_entropy(counts[letter], total);
+        }
+        if (score > best_score + 1e-12 || (std::fabs(score - best_score) <= 1e-12 && counts[letter] > best_count)) {
+            best = *c;
+            best_score = score;
+            best_count = counts[letter];
+        }
+    }
+    return best;
+}
+
+/**
+ * Picks a secret word uniformly from the whole dictionary.
+ */
+std::string random_word(const Dictionary& dictionary, std::mt19937_64& rng) {
+    size_t pick = std::uniform_int_distribution<size_t>(0, dictionary.word_count - 1)(rng);
+    for (int length = 1; length <= MAX_WORD_LENGTH; ++length) {
+        if (pick < dictionary.buckets[length].count) {
+            return word_at(dictionary, length, pick);
+        }
+        pick -= dictionary.buckets[length].count;
+    }
+    return "";
+}
+
+// The number of incorrect guesses allowed per game.
+const int MAX_GUESSES = 7;
+
+// A strategy that keeps repeating guesses cannot stall a headless game
+// past this many turns; the game is scored as lost.
+const int MAX_TURNS = 256;
+
+/**
+ * One game of the word game, without any input or output. Only incorrect
+ * guesses use up guesses; repeated guesses change nothing.
+ */
+struct Game {
+    std::string secret_word;
+    uint32_t secret_mask = 0;
+    GuessState state;
+    int guesses_left = MAX_GUESSES;
+    int turns = 0;  // Every guess made, including repeats.
+};
+
+enum class GuessOutcome { Invalid, Repeated, Correct, Incorrect, Won, Lost };
+
+Game new_game(const std::string& secret_word) {
+    Game game;
+    game.secret_word = secret_word;
+    for (char letter : secret_word) {
+        game.secret_mask |= 1u << (letter - 'a');
+    }
+    return game;
+}
+
+bool game_won(const Game& game) {
+    return (game.secret_mask & ~game.state.guessed) == 0;
+}
+
+bool game_over(const Game& game) {
+    return game.guesses_left == 0 || game_won(game) || game.turns >= MAX_TURNS;
+}
+
+/**
+ * Applies one guess to a game under the game's rules.
+ */
+GuessOutcome make_guess(Game& game, char guess) {
+    ++game.turns;
+    if (guess < 'a' || guess > 'z') {
+        return GuessOutcome::Invalid;
+    }
+    if (game.state.guessed & (1u << (guess - 'a'))) {
+        return GuessOutcome::Repeated;
+    }
+    apply_guess(game.state, game.secret_word, guess);
+    if (game.state.revealed[guess - 'a'] != 0) {
+        return game_won(game) ? GuessOutcome::Won : GuessOutcome::Correct;
+    }
+    --game.guesses_left;
+    return game.guesses_left == 0 ? GuessOutcome::Lost : GuessOutcome::Incorrect;
+}
+
+/**
+ * A way of choosing guesses in a headless game. A strategy sees only what
+ * a player would: the secret word's length and the guess state. One
+ * instance is used by one thread at a time and may keep state between
+ * games, such as caches.
+ */
+class GuessStrategy {
+public:
+    virtual ~GuessStrategy() = default;
+    virtual void begin(const Game& game) { (void)game; }
+    virtual char next_guess(const Game& game, std::mt19937_64& rng) = 0;
+    virtual void observe(const Game& game, char guess) {
+        (void)game;
+        (void)guess;
+    }
+};
+
+/**
+ * Guesses letters in fixed English frequency order.
+ */
+class FrequencyStrategy : public GuessStrategy {
+public:
+    char next_guess(const Game& game, std::mt19937_64&) override {
+        for (const char* c = FALLBACK_ORDER; *c; ++c) {
+            if (!(game.state.guessed & (1u << (*c - 'a')))) {
+                return *c;
+            }
+        }
+        return 0;
+    }
+};
+
+/**
+ * Guesses a uniformly random letter not yet tried.
+ */
+class RandomStrategy : public GuessStrategy {
+public:
+    char next_guess(const Game& game, std::mt19937_64& rng) override {
+        uint32_t left = ~game.state.guessed & ((1u << 26) - 1);
+        if (left == 0) {
+            return 0;
+        }
+        int skip = std::uniform_int_distribution<int>(0, __builtin_popcount(left) - 1)(rng);
+        while (skip-- > 0) {
+            left &= left - 1;
+        }
+        return static_cast<char>('a' + __builtin_ctz(left));
+    }
+};
+
+/**
+ * First guesses for every word length, computed once from the buckets'
+ * letter counts and shared read-only between threads.
+ */
+struct OpeningBook {
+    char first_guess[MAX_WORD_LENGTH + 1] = {};
+};
+
+OpeningBook build_opening_book(const Dictionary& dictionary) {
+    OpeningBook book;
+    for (int length = 1; length <= MAX_WORD_LENGTH; ++length) {
+        const LengthBucket& bucket = dictionary.buckets[length];
+        if (bucket.count > 0) {
+            std::vector<uint32_t> all(bucket.count);
+            for (size_t i = 0; i < bucket.count; ++i) {
+                all[i] = static_cast<uint32_t>(i);
+            }
+            book.first_guess[length] = best_guess(bucket, GuessState(), all);
+        }
+    }
+    return book;
+}
+
+/**
+ * Plays best_guess over the dictionary's candidates. The solver is
+ * deterministic, so every game of one length follows a path through the
+ * same tree of states: a node holds the words still possible and the
+ * letter to guess, and each reveal of that letter leads to a child. The
+ * tree is built lazily and kept, so the expensive early moves on large
+ * candidate sets are computed once per state rather than once per game.
+ * The first guess of every length comes from the shared opening book.
+ *
+ * Nodes do not keep their own candidate lists. The candidates of one
+ * length live in a single index array, and a node owns a range of it:
+ * each reveal splits off a different subset of its parent's words, so a
+ * new child's words are moved to the front of the parent's unclaimed part
+ * and the child takes that slice. Partitioning is stable, so every range
+ * stays in bucket order. The cache then costs one index per word plus the
+ * nodes themselves, instead of a copy of the candidates on every level.
+ */
+class SolverStrategy : public GuessStrategy {
+private:
+    struct Node {
+        uint32_t first = 0;    // This node's words are order[first, first + count).
+        uint32_t count = 0;
+        uint32_t claimed = 0;  // Words at the front of the range already given to children.
+        char guess = 0;
+        std::vector<std::pair<uint32_t, std::unique_ptr<Node>>> children;  // By reveal; usually few.
+    };
+
+    const Dictionary& dictionary;
+    const OpeningBook& book;
+    std::unique_ptr<Node> roots[MAX_WORD_LENGTH + 1];
+    std::vector<uint32_t> order[MAX_WORD_LENGTH + 1];
+    std::vector<uint32_t> scratch;
+    const LengthBucket* bucket = nullptr;
+    std::vector<uint32_t>* words = nullptr;
+    Node* node = nullptr;
+
+    /**
+     * Moves the parent's unclaimed words whose positions of a letter match
+     * a reveal to the front of the unclaimed part, keeping both groups in
+     * order, and leaves a copy of the matching words in scratch.
+     * @return The number of matching words.
+     */
+    uint32_t claim(Node& parent, int letter, uint32_t reveal) {
+        const uint32_t* positions = bucket->positions_of(letter);
+        uint32_t* begin = words->data() + parent.first + parent.claimed;
+        uint32_t* end = words->data() + parent.first + parent.count;
+        scratch.clear();
+        uint32_t* rest = begin;
+        for (uint32_t* it = begin; it != end; ++it) {
+            if (positions[*it] == reveal) {
+                scratch.push_back(*it);
+            } else {
+                *rest++ = *it;
+            }
+        }
+        std::move_backward(begin, rest, end);
+        std::copy(scratch.begin(), scratch.end(), begin);
+        return static_cast<uint32_t>(scratch.size());
+    }
+
+public:
+    SolverStrategy(const Dictionary& dictionary, const OpeningBook& book) : dictionary(dictionary), book(book) {}
+
+    void begin(const Game& game) override {
+        size_t length = game.secret_word.size();
+        bucket = &dictionary.buckets[length];
+        words = &order[length];
+        if (!roots[length]) {
+            words->resize(bucket->count);
+            for (size_t i = 0; i < bucket->count; ++i) {
+                (*words)[i] = static_cast<uint32_t>(i);
+            }
+            roots[length].reset(new Node());
+            roots[length]->count = static_cast<uint32_t>(bucket->count);
+            roots[length]->guess = book.first_guess[length];
+        }
+        node = roots[length].get();
+    }
+
+    char next_guess(const Game&, std::mt19937_64&) override {
+        return node->guess;
+    }
+
+    void observe(const Game& game, char guess) override {
+        if (game_over(game)) {
+            return;
+        }
+        uint32_t reveal = game.state.revealed[guess - 'a'];
+        auto found = std::find_if(node->children.begin(), node->children.end(),
+                                  [&](const std::pair<uint32_t, std::unique_ptr<Node>>& entry) { return entry.first == reveal; });
+        if (found == node->children.end()) {
+            std::unique_ptr<Node> child(new Node());
+            child->first = node->first + node->claimed;
+            child->count = claim(*node, guess - 'a', reveal);
+            node->claimed += child->count;
+            child->guess = best_guess(*bucket, game.state, scratch);
+            node->children.emplace_back(reveal, std::move(child));
+            found = node->children.end() - 1;
+        }
+        node = found->second.get();
+    }
+};
+
+/**
+ * Plays one headless game to the end with a strategy.
+ * @return The finished game.
+ */
+Game play_game(const std::string& secret_word, GuessStrategy& strategy, std::mt19937_64& rng) {
+    Game game = new_game(secret_word);
+    strategy.begin(game);
+    while (!game_over(game)) {
+        char guess = strategy.next_guess(game, rng);
+        if (make_guess(game, guess) == GuessOutcome::Invalid) {
+            break;  // The strategy has run out of letters.
+        }
+        strategy.observe(game, guess);
+    }
+    return game;
+}
+
+/**
+ * Totals from simulating many games.
+ */
+struct SimulationReport {
+    size_t games = 0;
+    size_t wins = 0;
+    size_t misses[MAX_GUESSES + 1] = {};       // Games by incorrect guesses used.
+    size_t guesses[27] = {};                   // Won games by distinct letters guessed.
+    size_t games_by_length[MAX_WORD_LENGTH + 1] = {};
+    size_t wins_by_length[MAX_WORD_LENGTH + 1] = {};
+    double seconds = 0;
+
+    void add(const SimulationReport& other) {
+        games += other.games;
+        wins += other.wins;
+        for (int i = 0; i <= MAX_GUESSES; ++i) misses[i] += other.misses[i];
+        for (int i = 0; i <= 26; ++i) guesses[i] += other.guesses[i];
+        for (int i = 0; i <= MAX_WORD_LENGTH; ++i) {
+            games_by_length[i] += other.games_by_length[i];
+            wins_by_length[i] += other.wins_by_length[i];
+        }
+    }
+};
+
+// Words per unit of work handed to a simulator thread.
+const size_t SIMULATION_CHUNK = 1024;
+
+// Upper bound for the simulator's thread count argument.
+const uint64_t MAX_SIMULATION_THREADS = 1024;
+
+/**
+ * Plays every word of a dictionary once as the secret word, spread over
+ * threads. Work is handed out in chunks of one bucket; each thread has
+ * its own strategy instance and PRNG, and the PRNG is reseeded from the
+ * seed and chunk number at the start of each chunk, so the results depend
+ * on the seed but not on the thread count or scheduling.
+ * @param dictionary The words to play.
+ * @param make_strategy Creates a strategy for one thread.
+ * @param threads The number of threads; 0 uses the hardware concurrency.
+ * @param seed The PRNG seed.
+ */
+SimulationReport simulate_dictionary(const Dictionary& dictionary,
+                                     const std::function<std::unique_ptr<GuessStrategy>()>& make_strategy,
+                                     unsigned threads, uint64_t seed) {
+    struct Chunk {
+        int length;
+        size_t first;
+        size_t last;
+    };
+    std::vector<Chunk> chunks;
+    for (int length = 1; length <= MAX_WORD_LENGTH; ++length) {
+        for (size_t first = 0; first < dictionary.buckets[length].count; first += SIMULATION_CHUNK) {
+            chunks.push_back({length, first, std::min(first + SIMULATION_CHUNK, dictionary.buckets[length].count)});
+        }
+    }
+
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // Threads beyond one per chunk would have nothing to do.
+    threads = static_cast<unsigned>(std::min<size_t>(threads, std::max<size_t>(1, chunks.size())));
+    std::vector<SimulationReport> reports(threads);
+    std::atomic<size_t> next_chunk{0};
+    auto worker = [&](unsigned t) {
+        std::unique_ptr<GuessStrategy> strategy = make_strategy();
+        std::mt19937_64 rng;
+        SimulationReport& report = reports[t];
+        for (size_t c = next_chunk++; c < chunks.size(); c = next_chunk++) {
+            rng.seed(seed ^ (0x9E3779B97F4A7C15ULL * (c + 1)));
+            const Chunk& chunk = chunks[c];
+            for (size_t i = chunk.first; i < chunk.last; ++i) {
+                Game game = play_game(word_at(dictionary, chunk.length, i), *strategy, rng);
+                bool won = game_won(game);
+                ++report.games;
+                ++report.games_by_length[chunk.length];
+                ++report.misses[MAX_GUESSES - game.guesses_left];
+                if (won) {
+                    ++report.wins;
+                    ++report.wins_by_length[chunk.length];
+                    ++report.guesses[__builtin_popcount(game.state.guessed)];
+                }
+            }
         }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) {
+        pool.emplace_back(worker, t);
+    }
+    worker(0);
+    for (auto& thread : pool) {
+        thread.join();
+    }
+
+    SimulationReport total;
+    for (const SimulationReport& report : reports) {
+        total.add(report);
+    }
+    total.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return total;
+}
+
+/**
+ * Prints a simulation report: win rate, how many incorrect guesses games
+ * used, how many letters won games took, win rate by word length, and
+ * throughput.
+ */
+void print_report(const std::string& name, const SimulationReport& report) {
+    char line[160];
+    std::string out = "Strategy: " + name + "\n";
+    snprintf(line, sizeof(line), "Games: %zu, wins: %zu (%.2f%%), %.0f games/s (%.2f s)\n", report.games, report.wins,
+             report.games ? 100.0 * report.wins / report.games : 0.0, report.games / report.seconds, report.seconds);
+    out += line;
+    out += "Incorrect guesses used:";
+    for (int i = 0; i <= MAX_GUESSES; ++i) {
+        snprintf(line, sizeof(line), " %d:%zu", i, report.misses[i]);
+        out += line;
+    }
+    out += "\nLetters guessed in won games:";
+    for (int i = 1; i <= 26; ++i) {
+        if (report.guesses[i]) {
+            snprintf(line, sizeof(line), " %d:%zu", i, report.guesses[i]);
+            out += line;
+        }
+    }
+    out += "\nWin rate by length:";
+    for (int length = 1; length <= MAX_WORD_LENGTH; ++length) {
+        if (report.games_by_length[length]) {
+            snprintf(line, sizeof(line), " %d:%.1f%%", length,
+                     100.0 * report.wins_by_length[length] / report.games_by_length[length]);
+            out += line;
+        }
+    }
+    std::cout << out << "\n" << std::endl;
+}
+
+/**
+ * Runs the simulator for one strategy, or all of them, and prints reports.
+ * @return false if the strategy name is unknown.
+ */
+bool run_simulation(const Dictionary& dictionary, const std::string& strategy, unsigned threads, uint64_t seed) {
+    OpeningBook book = build_opening_book(dictionary);
+    std::vector<std::pair<std::string, std::function<std::unique_ptr<GuessStrategy>()>>> strategies = {
+        {"solver", [&]() { return std::unique_ptr<GuessStrategy>(new SolverStrategy(dictionary, book)); }},
+        {"frequency", []() { return std::unique_ptr<GuessStrategy>(new FrequencyStrategy()); }},
+        {"random", []() { return std::unique_ptr<GuessStrategy>(new RandomStrategy()); }},
+    };
+    bool found = false;
+    for (const auto& entry : strategies) {
+        if (strategy == "all" || strategy == entry.first) {
+            found = true;
+            print_report(entry.first, simulate_dictionary(dictionary, entry.second, threads, seed));
+        }
+    }
+    if (!found) {
+        std::cerr << "Error: Unknown strategy '" << strategy << "' (use solver, frequency, random or all)." << std::endl;
+    }
+    return found;
+}
+
+/**
+ * Parses a whole argument as a decimal number from 0 to max.
+ * @return false for signs, other characters or values above max.
+ */
+bool parse_unsigned(const char* text, uint64_t max, uint64_t& value) {
+    if (!std::isdigit(static_cast<unsigned char>(text[0]))) {
+        return false;
+    }
+    char* end = nullptr;
+    errno = 0;
+    unsigned long long parsed = std::strtoull(text, &end, 10);
+    if (errno == ERANGE || *end != '\0' || parsed > max) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+void display_game_status(const std::string& secret_word, const std::string& guessed_letters) {
+    uint32_t guessed = 0;
+    for (char letter : guessed_letters) {
+        guessed |= 1u << (letter - 'a');
+    }
+    std::string status = "\nWord to guess: ";
+    for (char letter : secret_word) {
+        status += (guessed & (1u << (letter - 'a'))) ? letter : '_';
+        status += ' ';
     }
-    std::cout << "\nGuessed letters: " << guessed_letters << std::endl;
+    std::cout << status << "\nGuessed letters: " << guessed_letters << std::endl;
 }
 
-int main() {
-    std::srand(static_cast<unsigned int>(std::time(0)));
+int main(int argc, char* argv[]) {
+    // t23 --simulate <word file> [strategy] [threads] [seed] plays every
+    // word of the file with a strategy (solver, frequency, random or all)
+    // and reports the results.
+    if (argc > 1 && std::string(argv[1]) == "--simulate") {
+        uint64_t threads = 0;
+        uint64_t seed = 1;
+        if (argc < 3 || argc > 6 || (argc > 4 && !parse_unsigned(argv[4], MAX_SIMULATION_THREADS, threads)) ||
+            (argc > 5 && !parse_unsigned(argv[5], UINT64_MAX, seed))) {
+            std::cerr << "Error: usage: t23 --simulate <word file> [strategy] [threads] [seed]" << std::endl;
+            std::cerr << "  threads: 0 (all cores) to " << MAX_SIMULATION_THREADS << "; seed: a non-negative integer" << std::endl;
+            return 1;
+        }
+        Dictionary dictionary;
+        if (!load_dictionary(dictionary, argv[2])) {
+            return 1;
+        }
+        std::string strategy = argc > 3 ? argv[3] : "all";
+        bool ok = run_simulation(dictionary, strategy, static_cast<unsigned>(threads), seed);
+        close_dictionary(dictionary);
+        return ok ? 0 : 1;
+    }
 
-    std::vector<std::string> words = {"programming", "computer", "keyboard", "algorithm", "developer", "challenge", "internet"};
-    std::string secret_word = words[std::rand() % words.size()];
+    std::mt19937_64 rng(static_cast<uint64_t>(std::time(0)));
+
+    // t23 [word file] plays with words from a dictionary file, one per line.
+    Dictionary dictionary;
+    if (argc > 1) {
+        if (!load_dictionary(dictionary, argv[1])) {
+            return 1;
+        }
+    } else {
+        std::vector<std::string> words = {"programming", "computer", "keyboard", "algorithm", "developer", "challenge", "internet"};
+        build_dictionary(dictionary, words);
+    }
+    Game game = new_game(random_word(dictionary, rng));
+    const std::string& secret_word = game.secret_word;
+    const LengthBucket& bucket = dictionary.buckets[secret_word.size()];
     std::string guessed_letters = "";
-    int max_guesses = 7;
-    int guesses_left = max_guesses;
+    std::vector<uint32_t> candidates;
+    filter_candidates(bucket, game.state, candidates);
 
     std::cout << "Welcome to the Word Guessing Game!" << std::endl;
-    std::cout << "You have " << max_guesses << " guesses to find the secret word." << std::endl;
+    std::cout << "You have " << MAX_GUESSES << " guesses to find the secret word." << std::endl;
+    std::cout << "Enter '?' at any time for a hint." << std::endl;
 
-    while (guesses_left > 0) {
+    while (game.guesses_left > 0) {
         display_game_status(secret_word, guessed_letters);
-        std::cout << "You have " << guesses_left << " guesses left." << std::endl;
+        std::cout << "You have " << game.guesses_left << " guesses left." << std::endl;
 
         char guess;
         std::cout << "Enter a letter guess: ";
-        std::cin >> guess;
+        if (!(std::cin >> guess)) {
+            std::cout << "\nGoodbye! The word was: " << secret_word << std::endl;
+            break;
+        }
         guess = std::tolower(guess);
 
-        if (std::isalpha(guess)) {
-            if (guessed_letters.find(guess) != std::string::npos) {
-                std::cout << "You've already guessed that letter. Try another one!" << std::endl;
-                continue;
-            }
-
-            guessed_letters += guess;
+        if (guess == '?') {
+            char hint = best_guess(bucket, game.state, candidates);
+            std::cout << candidates.size() << " word" << (candidates.size() == 1 ? "" : "s")
+                      << " still fit. Hint: try '" << hint << "'." << std::endl;
+            continue;
+        }
 
-            if (secret_word.find(guess) != std::string::npos) {
-                std::cout << "Correct guess!" << std::endl;
-                bool all_found = true;
-                for (char letter : secret_word) {
-                    if (guessed_letters.find(letter) == std::string::npos) {
-                        all_found = false;
-                        break;
-                    }
-                }
-                if (all_found) {
-                    std::cout << "\nCongratulations! You've guessed the word: " << secret_word << std::endl;
-                    break;
-                }
-            } else {
-                std::cout << "Incorrect guess." << std::endl;
-                guesses_left--;
-            }
-        } else {
+        GuessOutcome outcome = make_guess(game, guess);
+        if (outcome == GuessOutcome::Invalid) {
             std::cout << "Invalid input. Please enter a letter." << std::endl;
+            continue;
+        }
+        if (outcome == GuessOutcome::Repeated) {
+            std::cout << "You've already guessed that letter. Try another one!" << std::endl;
+            continue;
         }
+        guessed_letters += guess;
+        refine_candidates(bucket, game.state, guess, candidates);
 
-        if (guesses_left == 0) {
-            std::cout << "\nGame over! The word was: " << secret_word << std::endl;
+        if (outcome == GuessOutcome::Correct || outcome == GuessOutcome::Won) {
+            std::cout << "Correct guess!" << std::endl;
+            if (outcome == GuessOutcome::Won) {
+                std::cout << "\nCongratulations! You've guessed the word: " << secret_word << std::endl;
+                break;
+            }
+        } else {
+            std::cout << "Incorrect guess." << std::endl;
+            if (outcome == GuessOutcome::Lost) {
+                std::cout << "\nGame over! The word was: " << secret_word << std::endl;
+            }
         }
     }
 
+    close_dictionary(dictionary);
     return 0;
 }
\ No newline at end of file